@@ -0,0 +1,113 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+class HammingOneChunkData
+{
+public:
+    HammingOneChunkData(const vk::raii::Device &device,
+                        const std::shared_ptr<VmaAllocator_T> &allocator,
+                        uint32_t queueFamilyIndex,
+                        uint32_t transferQueueFamilyIndex,
+                        vk::DeviceSize size)
+        : commandPool{device, vk::CommandPoolCreateInfo{vk::CommandPoolCreateFlags{}, queueFamilyIndex}},
+
+          commandBuffer{intvlk::makeCommandBuffer(device, commandPool)},
+
+          transferCommandPool{device, vk::CommandPoolCreateInfo{vk::CommandPoolCreateFlags{}, transferQueueFamilyIndex}},
+
+          transferCommandBuffer{intvlk::makeCommandBuffer(device, transferCommandPool)},
+
+          deviceBufferData{device,
+                           allocator,
+                           size,
+                           vk::BufferUsageFlagBits::eStorageBuffer |
+                               vk::BufferUsageFlagBits::eTransferSrc |
+                               vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                           VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                           {},
+                           VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                               VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                               VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT},
+
+          deviceBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{deviceBufferData.buffer})},
+
+          hostBufferData{makeHostBufferData(device, allocator, deviceBufferData, size)}
+    {
+    }
+
+    // The staging buffer is only needed when VMA placed the device buffer in memory
+    // the host cannot map, which is usual for discrete GPUs without resizable BAR.
+    static intvlk::vma_utils::BufferData makeHostBufferData(const vk::raii::Device &device,
+                                                            const std::shared_ptr<VmaAllocator_T> &allocator,
+                                                            const intvlk::vma_utils::BufferData &deviceBufferData,
+                                                            vk::DeviceSize size)
+    {
+        if (deviceBufferData.memoryProperties & vk::MemoryPropertyFlagBits::eHostVisible)
+        {
+            return intvlk::vma_utils::BufferData{nullptr};
+        }
+        return intvlk::vma_utils::BufferData{device,
+                                             allocator,
+                                             size,
+                                             vk::BufferUsageFlagBits::eTransferDst,
+                                             VMA_MEMORY_USAGE_AUTO,
+                                             {},
+                                             VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT};
+    }
+
+    static std::vector<HammingOneChunkData> make(uint32_t chunkBufferCount,
+                                                 const vk::raii::Device &device,
+                                                 const std::shared_ptr<VmaAllocator_T> &allocator,
+                                                 uint32_t queueFamilyIndex,
+                                                 uint32_t transferQueueFamilyIndex,
+                                                 vk::DeviceSize size)
+    {
+        std::vector<HammingOneChunkData> chunkData{};
+        chunkData.reserve(chunkBufferCount);
+        for (uint32_t i{0}; i < chunkBufferCount; ++i)
+        {
+            chunkData.emplace_back(device, allocator, queueFamilyIndex, transferQueueFamilyIndex, size);
+        }
+        return chunkData;
+    }
+
+    // True when results are read straight from the device buffer.
+    bool isReadInPlace() const
+    {
+        return static_cast<bool>(deviceBufferData.memoryProperties & vk::MemoryPropertyFlagBits::eHostVisible);
+    }
+
+    const intvlk::vma_utils::BufferData &getReadbackBufferData() const
+    {
+        return isReadInPlace() ? deviceBufferData : hostBufferData;
+    }
+
+    vk::raii::CommandPool commandPool{VK_NULL_HANDLE};
+    vk::raii::CommandBuffer commandBuffer{nullptr};
+    // Records the readback on the transfer queue, so it overlaps the next chunk's dispatch.
+    vk::raii::CommandPool transferCommandPool{VK_NULL_HANDLE};
+    vk::raii::CommandBuffer transferCommandBuffer{nullptr};
+    // Compute queue timeline value signaled when the last submitted chunk is generated.
+    uint64_t submitValue{};
+    // Transfer queue timeline value signaled when its readback is done, unless read in place.
+    uint64_t readbackValue{};
+    intvlk::vma_utils::BufferData deviceBufferData{nullptr};
+    vk::DeviceAddress deviceBufferAddress{};
+    intvlk::vma_utils::BufferData hostBufferData{nullptr};
+};
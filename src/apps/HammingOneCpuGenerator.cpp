@@ -0,0 +1,349 @@
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "HammingOneCpuGenerator.hpp"
+
+#include <format>
+#include <iostream>
+#include <utility>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HAMMING_ONE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(HAMMING_ONE_X86) && !defined(_MSC_VER)
+#define HAMMING_ONE_TARGET_AVX2 __attribute__((target("avx2")))
+#define HAMMING_ONE_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define HAMMING_ONE_TARGET_AVX2
+#define HAMMING_ONE_TARGET_AVX512
+#endif
+
+namespace
+{
+    using namespace hamming_one_random;
+
+    // Fills words[j] with the create stream word j of a sequence, before masking.
+    void fillWordsScalar(uint32_t seed, uint32_t sequence, uint32_t wordCount, uint32_t *words)
+    {
+        for (uint32_t j{0}; j < wordCount; ++j)
+        {
+            words[j] = randomWord(seed, Stream::eCreate, sequence, j);
+        }
+    }
+
+#if defined(HAMMING_ONE_X86)
+    // The SIMD kernels run one Philox4x32-10 instance per lane, with consecutive
+    // word indices as the first counter word.
+
+    HAMMING_ONE_TARGET_AVX2 inline void mulhilo(__m256i a, __m256i b, __m256i &hi, __m256i &lo)
+    {
+        const __m256i even{_mm256_mul_epu32(a, b)};
+        const __m256i odd{_mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32))};
+        lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+        hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+    }
+
+    HAMMING_ONE_TARGET_AVX2 void fillWordsAvx2(uint32_t seed, uint32_t sequence, uint32_t wordCount, uint32_t *words)
+    {
+        const __m256i m0{_mm256_set1_epi32(static_cast<int>(philoxM0))};
+        const __m256i m1{_mm256_set1_epi32(static_cast<int>(philoxM1))};
+        const __m256i lanes{_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)};
+        uint32_t j{0};
+        for (; j + 8 <= wordCount; j += 8)
+        {
+            __m256i c0{_mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(j)), lanes)};
+            __m256i c1{_mm256_set1_epi32(static_cast<int>(sequence))};
+            __m256i c2{_mm256_set1_epi32(static_cast<int>(Stream::eCreate))};
+            __m256i c3{_mm256_setzero_si256()};
+            uint32_t k0{seed};
+            uint32_t k1{keyTag};
+            for (uint32_t i{0}; i < 10; ++i)
+            {
+                if (0 < i)
+                {
+                    k0 += philoxW0;
+                    k1 += philoxW1;
+                }
+                __m256i hi0{}, lo0{}, hi1{}, lo1{};
+                mulhilo(m0, c0, hi0, lo0);
+                mulhilo(m1, c2, hi1, lo1);
+                c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(static_cast<int>(k0)));
+                c1 = lo1;
+                c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(static_cast<int>(k1)));
+                c3 = lo0;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(words + j), c0);
+        }
+        for (; j < wordCount; ++j)
+        {
+            words[j] = randomWord(seed, Stream::eCreate, sequence, j);
+        }
+    }
+
+    HAMMING_ONE_TARGET_AVX512 inline void mulhilo(__m512i a, __m512i b, __m512i &hi, __m512i &lo)
+    {
+        const __m512i even{_mm512_mul_epu32(a, b)};
+        const __m512i odd{_mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32))};
+        lo = _mm512_mask_blend_epi32(0xAAAA, even, _mm512_slli_epi64(odd, 32));
+        hi = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+    }
+
+    HAMMING_ONE_TARGET_AVX512 void fillWordsAvx512(uint32_t seed, uint32_t sequence, uint32_t wordCount, uint32_t *words)
+    {
+        const __m512i m0{_mm512_set1_epi32(static_cast<int>(philoxM0))};
+        const __m512i m1{_mm512_set1_epi32(static_cast<int>(philoxM1))};
+        const __m512i lanes{_mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)};
+        uint32_t j{0};
+        for (; j + 16 <= wordCount; j += 16)
+        {
+            __m512i c0{_mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(j)), lanes)};
+            __m512i c1{_mm512_set1_epi32(static_cast<int>(sequence))};
+            __m512i c2{_mm512_set1_epi32(static_cast<int>(Stream::eCreate))};
+            __m512i c3{_mm512_setzero_si512()};
+            uint32_t k0{seed};
+            uint32_t k1{keyTag};
+            for (uint32_t i{0}; i < 10; ++i)
+            {
+                if (0 < i)
+                {
+                    k0 += philoxW0;
+                    k1 += philoxW1;
+                }
+                __m512i hi0{}, lo0{}, hi1{}, lo1{};
+                mulhilo(m0, c0, hi0, lo0);
+                mulhilo(m1, c2, hi1, lo1);
+                c0 = _mm512_xor_si512(_mm512_xor_si512(hi1, c1), _mm512_set1_epi32(static_cast<int>(k0)));
+                c1 = lo1;
+                c2 = _mm512_xor_si512(_mm512_xor_si512(hi0, c3), _mm512_set1_epi32(static_cast<int>(k1)));
+                c3 = lo0;
+            }
+            _mm512_storeu_si512(words + j, c0);
+        }
+        for (; j < wordCount; ++j)
+        {
+            words[j] = randomWord(seed, Stream::eCreate, sequence, j);
+        }
+    }
+#endif
+
+    SimdLevel detectSimdLevel()
+    {
+#if defined(HAMMING_ONE_X86) && defined(_MSC_VER)
+        std::array<int, 4> info{};
+        __cpuid(info.data(), 0);
+        if (info[0] < 7)
+        {
+            return SimdLevel::eScalar;
+        }
+        __cpuid(info.data(), 1);
+        if (!(info[2] & (1 << 27)))
+        {
+            return SimdLevel::eScalar;
+        }
+        const unsigned long long xcr0{_xgetbv(0)};
+        __cpuidex(info.data(), 7, 0);
+        if ((info[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6)
+        {
+            return SimdLevel::eAvx512;
+        }
+        if ((info[1] & (1 << 5)) && (xcr0 & 0x6) == 0x6)
+        {
+            return SimdLevel::eAvx2;
+        }
+#elif defined(HAMMING_ONE_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            return SimdLevel::eAvx512;
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return SimdLevel::eAvx2;
+        }
+#endif
+        return SimdLevel::eScalar;
+    }
+
+    std::string_view toString(SimdLevel simdLevel)
+    {
+        switch (simdLevel)
+        {
+        case SimdLevel::eAvx2:
+            return "AVX2";
+        case SimdLevel::eAvx512:
+            return "AVX-512";
+        default:
+            return "scalar";
+        }
+    }
+}
+
+HammingOneCpuGenerator::HammingOneCpuGenerator(const HammingOneOptions &options)
+    : options{options.validate()},
+
+      sequenceWordCount{options.getSequenceWordCount()},
+
+      packedWordCount{(options.length + 31) / 32},
+
+      chunkSize{options.getChunkSize()},
+
+      chunkCount{options.getChunkCount()},
+
+      simdLevel{detectSimdLevel()},
+
+      fillWords{fillWordsScalar},
+
+      threadPool{options.generatorThreadCount}
+{
+#if defined(HAMMING_ONE_X86)
+    if (simdLevel == SimdLevel::eAvx512)
+    {
+        fillWords = fillWordsAvx512;
+    }
+    else if (simdLevel == SimdLevel::eAvx2)
+    {
+        fillWords = fillWordsAvx2;
+    }
+#endif
+}
+
+SimdLevel HammingOneCpuGenerator::getSimdLevel() const
+{
+    return simdLevel;
+}
+
+void HammingOneCpuGenerator::generateSequences(uint32_t seed,
+                                               uint32_t firstSequence,
+                                               uint32_t sequenceCount,
+                                               uint32_t *data) const
+{
+    const uint32_t part{options.createCount - options.changeCount};
+    const uint32_t tail{options.length % 32};
+    const uint32_t lastWordMask{tail != 0 ? (1U << tail) - 1 : ~0U};
+    std::vector<uint32_t> packedSequence(options.storage == Storage::ePacked ? 0 : packedWordCount);
+    for (uint32_t i{0}; i < sequenceCount; ++i)
+    {
+        const uint32_t sequence{firstSequence + i};
+        uint32_t *sequenceData{data + static_cast<size_t>(i) * sequenceWordCount};
+        uint32_t *words{options.storage == Storage::ePacked ? sequenceData : packedSequence.data()};
+
+        // The last changeCount sequences duplicate the first ones.
+        fillWords(seed, sequence < part ? sequence : sequence - part, packedWordCount, words);
+        words[packedWordCount - 1] &= lastWordMask;
+        if (sequence < options.changeCount)
+        {
+            const uint32_t position{hamming_one_random::changePosition(seed, options, sequence)};
+            words[position / 32] ^= 1U << (position % 32);
+        }
+
+        if (options.storage == Storage::eUnpacked)
+        {
+            for (uint32_t j{0}; j < options.length; ++j)
+            {
+                sequenceData[j] = (words[j / 32] >> (j % 32)) & 1;
+            }
+        }
+    }
+}
+
+std::vector<std::future<void>> HammingOneCpuGenerator::generateChunk(uint32_t chunk, uint32_t seed, uint32_t *data)
+{
+    const uint32_t firstSequence{chunk * chunkSize};
+    const uint32_t sequenceCount{std::min(chunkSize, options.createCount - firstSequence)};
+    // A few tasks per thread even out sequences that finish at different speeds.
+    const uint32_t taskCount{std::min(sequenceCount, 4 * threadPool.getThreadCount())};
+    const uint32_t taskSequenceCount{(sequenceCount + taskCount - 1) / taskCount};
+
+    std::vector<std::future<void>> tasks{};
+    tasks.reserve(taskCount);
+    for (uint32_t first{0}; first < sequenceCount; first += taskSequenceCount)
+    {
+        const uint32_t count{std::min(taskSequenceCount, sequenceCount - first)};
+        uint32_t *taskData{data + static_cast<size_t>(first) * sequenceWordCount};
+        tasks.emplace_back(threadPool.submit([this, seed, firstSequence, first, count, taskData]
+                                             { generateSequences(seed, firstSequence + first, count, taskData); }));
+    }
+    return tasks;
+}
+
+void HammingOneCpuGenerator::run()
+{
+    const uint32_t seed{options.seed ? *options.seed : hamming_one_random::makeTimeBasedSeed()};
+    const auto startTime{std::chrono::high_resolution_clock::now()};
+
+    HammingOneWriter writer{options, seed};
+
+    // Two chunk buffers, so the next chunk is generated while the current one is written out.
+    std::array<std::vector<uint32_t>, 2> chunkData{};
+    for (auto &data : chunkData)
+    {
+        data.resize(static_cast<size_t>(chunkSize) * sequenceWordCount);
+    }
+
+    std::vector<std::future<void>> tasks{generateChunk(0, seed, chunkData[0].data())};
+    try
+    {
+        for (uint32_t chunk{0}; chunk < chunkCount; ++chunk)
+        {
+            {
+                intvlk::Profiler::CpuScope generateScope{profiler, "generate"};
+                intvlk::ThreadPool::waitAll(std::exchange(tasks, {}));
+            }
+            if (chunk + 1 < chunkCount)
+            {
+                tasks = generateChunk(chunk + 1, seed, chunkData[(chunk + 1) % 2].data());
+            }
+
+            const uint32_t sequenceCount{std::min(chunkSize, options.createCount - chunk * chunkSize)};
+            intvlk::Profiler::CpuScope writeScope{profiler,
+                                                  "write",
+                                                  static_cast<uint64_t>(sequenceCount) * sequenceWordCount * sizeof(uint32_t)};
+            writer.write(chunkData[chunk % 2].data(), sequenceCount);
+        }
+    }
+    catch (...)
+    {
+        // The tasks write into chunkData, so none may outlive an error. Their own errors
+        // are dropped in favor of the one being handled.
+        try
+        {
+            intvlk::ThreadPool::waitAll(std::move(tasks));
+        }
+        catch (...)
+        {
+        }
+        throw;
+    }
+
+    const std::chrono::duration<double> elapsedTime{std::chrono::high_resolution_clock::now() - startTime};
+    const double size{static_cast<double>(options.createCount) * packedWordCount * sizeof(uint32_t)};
+    std::cout << std::format("Generated {} sequences of {} bits in {:.3f} s ({:.2f} GB/s, {}, {} threads)\n",
+                             options.createCount,
+                             options.length,
+                             elapsedTime.count(),
+                             size / elapsedTime.count() * 1e-9,
+                             toString(simdLevel),
+                             threadPool.getThreadCount());
+    profiler.report(std::cout);
+    if (!options.profileFilename.empty())
+    {
+        profiler.writeJson(options.profileFilename);
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include "HammingOneOptions.hpp"
+#include "HammingOneRandom.hpp"
+#include "HammingOneWriter.hpp"
+#include "VulkanApp.hpp"
+
+enum class SimdLevel : uint32_t
+{
+    eScalar,
+    eAvx2,
+    eAvx512
+};
+
+// Generates the same datasets as HammingOneGenerator without a Vulkan device.
+class HammingOneCpuGenerator : public VulkanApp
+{
+public:
+    explicit HammingOneCpuGenerator(const HammingOneOptions &options);
+
+    void run() override;
+
+    SimdLevel getSimdLevel() const;
+
+private:
+    using FillWords = void (*)(uint32_t seed, uint32_t sequence, uint32_t wordCount, uint32_t *words);
+
+    std::vector<std::future<void>> generateChunk(uint32_t chunk, uint32_t seed, uint32_t *data);
+    void generateSequences(uint32_t seed, uint32_t firstSequence, uint32_t sequenceCount, uint32_t *data) const;
+
+    HammingOneOptions options;
+    uint32_t sequenceWordCount;
+    uint32_t packedWordCount;
+    uint32_t chunkSize;
+    uint32_t chunkCount;
+    SimdLevel simdLevel;
+    FillWords fillWords;
+    intvlk::ThreadPool threadPool;
+    intvlk::Profiler profiler{};
+};
@@ -0,0 +1,158 @@
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "HammingOneCpuSolver.hpp"
+
+#include <bit>
+#include <chrono>
+#include <format>
+#include <iostream>
+
+namespace
+{
+    uint64_t bitKey(uint32_t bit)
+    {
+        // SplitMix64 finalizer, a bijection, so every bit gets a distinct key.
+        uint64_t key{(static_cast<uint64_t>(bit) + 1) * 0x9E3779B97F4A7C15};
+        key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9;
+        key = (key ^ (key >> 27)) * 0x94D049BB133111EB;
+        return key ^ (key >> 31);
+    }
+
+    bool testBit(const uint32_t *sequence, uint32_t bit)
+    {
+        return (sequence[bit / 32] >> (bit % 32)) & 1;
+    }
+}
+
+HammingOneCpuSolver::HammingOneCpuSolver(const HammingOneSolverOptions &options)
+    : options{options},
+
+      dataset{options.inputFilename},
+
+      tableSize{dataset.getHashTableSize()},
+
+      hashes(dataset.count),
+
+      threadPool{options.threadCount}
+{
+}
+
+bool HammingOneCpuSolver::differOnlyIn(uint32_t first, uint32_t second, uint32_t bit) const
+{
+    const uint32_t *firstSequence{dataset.getSequence(first)};
+    const uint32_t *secondSequence{dataset.getSequence(second)};
+    for (uint32_t word{0}; word < dataset.wordCount; ++word)
+    {
+        if ((firstSequence[word] ^ secondSequence[word]) != (word == bit / 32 ? 1U << (bit % 32) : 0))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void HammingOneCpuSolver::hashSequences(uint32_t firstSequence, uint32_t sequenceCount)
+{
+    for (uint32_t sequence{firstSequence}; sequence < firstSequence + sequenceCount; ++sequence)
+    {
+        const uint32_t *sequenceData{dataset.getSequence(sequence)};
+        uint64_t hash{0};
+        for (uint32_t word{0}; word < dataset.wordCount; ++word)
+        {
+            for (uint32_t bits{sequenceData[word]}; bits != 0; bits &= bits - 1)
+            {
+                hash ^= bitKey(32 * word + static_cast<uint32_t>(std::countr_zero(bits)));
+            }
+        }
+        hashes[sequence] = hash;
+    }
+}
+
+void HammingOneCpuSolver::solveBits(uint32_t firstBit, uint32_t bitCount, std::vector<HammingOnePair> &pairs) const
+{
+    std::vector<TableSlot> table(tableSize);
+    for (uint32_t bit{firstBit}; bit < firstBit + bitCount; ++bit)
+    {
+        std::fill(table.begin(), table.end(), TableSlot{0, emptySlot});
+        const uint64_t key{bitKey(bit)};
+        for (uint32_t sequence{0}; sequence < dataset.count; ++sequence)
+        {
+            // The hash of the sequence with this bit cleared.
+            const uint64_t maskedHash{hashes[sequence] ^ (testBit(dataset.getSequence(sequence), bit) ? key : 0)};
+            const auto tag{static_cast<uint32_t>(maskedHash >> 32)};
+            auto slot{static_cast<uint32_t>(maskedHash) & (tableSize - 1)};
+            for (; table[slot].sequence != emptySlot; slot = (slot + 1) & (tableSize - 1))
+            {
+                const uint32_t other{table[slot].sequence};
+                if (table[slot].tag == tag && differOnlyIn(other, sequence, bit))
+                {
+                    pairs.push_back({other, sequence});
+                }
+            }
+            table[slot] = TableSlot{tag, sequence};
+        }
+    }
+}
+
+void HammingOneCpuSolver::run()
+{
+    const auto startTime{std::chrono::high_resolution_clock::now()};
+
+    // Masked hashes are derived from these in constant time per bit.
+    const uint32_t hashTaskSequenceCount{(dataset.count + threadPool.getThreadCount() - 1) /
+                                         threadPool.getThreadCount()};
+    std::vector<std::future<void>> hashTasks{};
+    for (uint32_t first{0}; first < dataset.count; first += hashTaskSequenceCount)
+    {
+        const uint32_t count{std::min(hashTaskSequenceCount, dataset.count - first)};
+        hashTasks.emplace_back(threadPool.submit([this, first, count]
+                                                 { hashSequences(first, count); }));
+    }
+    for (auto &task : hashTasks)
+    {
+        task.get();
+    }
+
+    const uint32_t taskCount{std::min(dataset.length, threadPool.getThreadCount())};
+    const uint32_t taskBitCount{(dataset.length + taskCount - 1) / taskCount};
+    std::vector<std::vector<HammingOnePair>> taskPairs(taskCount);
+    std::vector<std::future<void>> tasks{};
+    tasks.reserve(taskCount);
+    for (uint32_t task{0}; task < taskCount; ++task)
+    {
+        const uint32_t firstBit{task * taskBitCount};
+        const uint32_t bitCount{std::min(taskBitCount, dataset.length - std::min(firstBit, dataset.length))};
+        tasks.emplace_back(threadPool.submit([this, firstBit, bitCount, &pairs = taskPairs[task]]
+                                             { solveBits(firstBit, bitCount, pairs); }));
+    }
+
+    std::vector<HammingOnePair> pairs{};
+    for (uint32_t task{0}; task < taskCount; ++task)
+    {
+        tasks[task].get();
+        pairs.insert(pairs.end(), taskPairs[task].begin(), taskPairs[task].end());
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    const std::chrono::duration<double> elapsedTime{std::chrono::high_resolution_clock::now() - startTime};
+    writeHammingOnePairs(options.outputFilename, pairs);
+    std::cout << std::format("Found {} pairs among {} sequences of {} bits in {:.3f} s ({} threads)\n",
+                             pairs.size(),
+                             dataset.count,
+                             dataset.length,
+                             elapsedTime.count(),
+                             threadPool.getThreadCount());
+}
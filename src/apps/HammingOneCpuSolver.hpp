@@ -0,0 +1,57 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "include.hpp"
+
+#include "HammingOneDataset.hpp"
+#include "HammingOneOptions.hpp"
+#include "VulkanApp.hpp"
+
+// Finds every pair of sequences at Hamming distance one on the CPU. For each bit
+// position every sequence is hashed with that bit masked out, and sequences that
+// collide in the table of that position are neighbours if they differ in the bit.
+// Bit positions are split across threads, each with its own table, so no locking
+// is needed. Serves as the reference for HammingOneSolver and the generators.
+class HammingOneCpuSolver : public VulkanApp
+{
+public:
+    explicit HammingOneCpuSolver(const HammingOneSolverOptions &options);
+
+    void run() override;
+
+private:
+    // Slot of an open-addressing table; a sequence of emptySlot marks a free slot.
+    class TableSlot
+    {
+    public:
+        uint32_t tag;
+        uint32_t sequence;
+    };
+
+    static constexpr uint32_t emptySlot{0xFFFFFFFF};
+
+    void hashSequences(uint32_t firstSequence, uint32_t sequenceCount);
+    void solveBits(uint32_t firstBit, uint32_t bitCount, std::vector<HammingOnePair> &pairs) const;
+    bool differOnlyIn(uint32_t first, uint32_t second, uint32_t bit) const;
+
+    HammingOneSolverOptions options;
+    HammingOneDataset dataset;
+    uint32_t tableSize;
+    std::vector<uint64_t> hashes;
+    intvlk::ThreadPool threadPool;
+};
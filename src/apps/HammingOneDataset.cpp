@@ -0,0 +1,114 @@
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "HammingOneDataset.hpp"
+
+#include "HammingOneWriter.hpp"
+
+HammingOneDataset::HammingOneDataset(const std::string &filename)
+{
+    std::ifstream file{filename, std::ios::binary};
+    if (!file)
+    {
+        throw intvlk::Error{"Failed to open file: " + filename};
+    }
+
+    std::array<char, 4> magic{};
+    file.read(magic.data(), magic.size());
+    file.seekg(0);
+    if (file && magic == HammingOneHeader::expectedMagic)
+    {
+        readBinary(file, filename);
+    }
+    else
+    {
+        file.clear();
+        readText(file, filename);
+    }
+    if (count == 0)
+    {
+        throw intvlk::Error{"Empty Hamming-one dataset: " + filename};
+    }
+}
+
+void HammingOneDataset::readBinary(std::ifstream &file, const std::string &filename)
+{
+    HammingOneHeader header{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || header.version != HammingOneHeader::currentVersion || header.headerSize < sizeof(header) ||
+        header.wordCount != (header.length + 31) / 32)
+    {
+        throw intvlk::Error{"Unsupported Hamming-one file: " + filename};
+    }
+    count = header.count;
+    length = header.length;
+    wordCount = header.wordCount;
+
+    file.seekg(header.headerSize);
+    data.resize(static_cast<size_t>(count) * wordCount);
+    file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(uint32_t)));
+    if (!file)
+    {
+        throw intvlk::Error{"Failed to read file: " + filename};
+    }
+}
+
+void HammingOneDataset::readText(std::ifstream &file, const std::string &filename)
+{
+    if (!(file >> count >> length) || length == 0)
+    {
+        throw intvlk::Error{"Unsupported Hamming-one file: " + filename};
+    }
+    wordCount = (length + 31) / 32;
+    data.assign(static_cast<size_t>(count) * wordCount, 0);
+
+    std::string row{};
+    std::getline(file, row);
+    for (uint32_t i{0}; i < count; ++i)
+    {
+        std::getline(file, row);
+        if (!file || row.size() < length)
+        {
+            throw intvlk::Error{"Failed to read file: " + filename};
+        }
+        uint32_t *sequence{data.data() + static_cast<size_t>(i) * wordCount};
+        for (uint32_t j{0}; j < length; ++j)
+        {
+            sequence[j / 32] |= static_cast<uint32_t>(row[j] == '1') << (j % 32);
+        }
+    }
+}
+
+void writeHammingOnePairs(const std::string &filename, const std::vector<HammingOnePair> &pairs)
+{
+    std::ofstream file{filename};
+    if (!file)
+    {
+        throw intvlk::Error{"Failed to open file: " + filename};
+    }
+    std::string text{};
+    for (const auto &pair : pairs)
+    {
+        text += std::to_string(pair[0]);
+        text += ' ';
+        text += std::to_string(pair[1]);
+        text += '\n';
+    }
+    file.write(text.data(), static_cast<std::streamsize>(text.size()));
+    if (!file)
+    {
+        throw intvlk::Error{"Failed to write file: " + filename};
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "include.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+
+using HammingOnePair = std::array<uint32_t, 2>;
+
+// Packed sequences read from a file written by HammingOneWriter, in either output format.
+class HammingOneDataset
+{
+public:
+    explicit HammingOneDataset(const std::string &filename);
+
+    const uint32_t *getSequence(uint32_t sequence) const
+    {
+        return data.data() + static_cast<size_t>(sequence) * wordCount;
+    }
+
+    // Slots of the hash tables both solvers build over the sequences, a power of two.
+    uint32_t getHashTableSize() const
+    {
+        return std::bit_ceil(hashTableSlotsPerSequence * std::max(count, 1U));
+    }
+
+    // At most half of the slots are used, which keeps probe sequences short.
+    static constexpr uint32_t hashTableSlotsPerSequence{2};
+
+    uint32_t count{};
+    uint32_t length{};
+    uint32_t wordCount{};
+    std::vector<uint32_t> data{};
+
+private:
+    void readBinary(std::ifstream &file, const std::string &filename);
+    void readText(std::ifstream &file, const std::string &filename);
+};
+
+// Writes one "first second" line per pair.
+void writeHammingOnePairs(const std::string &filename, const std::vector<HammingOnePair> &pairs);
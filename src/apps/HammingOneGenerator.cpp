@@ -15,12 +15,12 @@
 
 #include "HammingOneGenerator.hpp"
 
-HammingOneGenerator::HammingOneGenerator(uint32_t createCount, uint32_t changeCount, uint32_t length)
-    : createCount{createCount},
+#include "HammingOneCpuGenerator.hpp"
 
-      changeCount{changeCount},
+#include <iostream>
 
-      length{length},
+HammingOneGenerator::HammingOneGenerator(const HammingOneOptions &options)
+    : options{options.validate()},
 
       instance{intvlk::makeInstance(context,
                                     appName,
@@ -38,19 +38,27 @@ HammingOneGenerator::HammingOneGenerator(uint32_t createCount, uint32_t changeCo
 
       maxWorkGroupSizeX{physicalDevice.getProperties().limits.maxComputeWorkGroupSize[0]},
 
-      createGroupCountX{(createCount * length + maxWorkGroupSizeX - 1) / maxWorkGroupSizeX},
+      sequenceWordCount{options.getSequenceWordCount()},
 
-      changeGroupCountX{(changeCount + maxWorkGroupSizeX - 1) / maxWorkGroupSizeX},
+      chunkSize{std::min(options.getChunkSize(), getMaxChunkSize())},
 
-      computeQueueFamilyIndex{intvlk::findQueueFamilyIndex(physicalDevice, vk::QueueFlagBits::eCompute)},
+      chunkCount{(options.createCount + chunkSize - 1) / chunkSize},
 
-      device{intvlk::makeDevice(physicalDevice, {}, computeQueueFamilyIndex)},
+      computeQueueFamilyIndex{intvlk::findComputeQueueFamilyIndex(physicalDevice)},
 
-      commandPool{device, vk::CommandPoolCreateInfo{vk::CommandPoolCreateFlags{}, computeQueueFamilyIndex}},
+      transferQueueFamilyIndex{intvlk::findTransferQueueFamilyIndex(physicalDevice, computeQueueFamilyIndex)},
 
-      commandBuffer{intvlk::makeCommandBuffer(device, commandPool)},
+      queueRequests{{computeQueueFamilyIndex, computeQueuePriority}, {transferQueueFamilyIndex, transferQueuePriority}},
 
-      computeQueue{device, computeQueueFamilyIndex, 0},
+      queueIndices{intvlk::getQueueIndices(physicalDevice, queueRequests)},
+
+      device{intvlk::makeDevice(physicalDevice, {}, queueRequests)},
+
+      computeQueue{device, computeQueueFamilyIndex, queueIndices[0]},
+
+      transferQueue{device, transferQueueFamilyIndex, queueIndices[1]},
+
+      pipelineCache{physicalDevice, device, "hamming_one_generator.pipeline_cache"},
 
       allocator{intvlk::vma_utils::makeAllocator(VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT,
                                                  physicalDevice,
@@ -58,29 +66,18 @@ HammingOneGenerator::HammingOneGenerator(uint32_t createCount, uint32_t changeCo
                                                  instance,
                                                  vk::ApiVersion13)},
 
-      deviceBufferData{device,
-                       allocator,
-                       createGroupCountX * maxWorkGroupSizeX * sizeof(uint32_t),
-                       vk::BufferUsageFlagBits::eStorageBuffer |
-                           vk::BufferUsageFlagBits::eTransferSrc |
-                           vk::BufferUsageFlagBits::eShaderDeviceAddress,
-                       VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
-                       {},
-                       VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
-                           VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT},
-
-      deviceBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{deviceBufferData.buffer})},
-
-      hostBufferData{device,
-                     allocator,
-                     createGroupCountX * maxWorkGroupSizeX * sizeof(uint32_t),
-                     vk::BufferUsageFlagBits::eStorageBuffer |
-                         vk::BufferUsageFlagBits::eTransferDst |
-                         vk::BufferUsageFlagBits::eShaderDeviceAddress,
-                     VMA_MEMORY_USAGE_AUTO,
-                     {},
-                     VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
-                         VMA_ALLOCATION_CREATE_MAPPED_BIT}
+      chunkData{HammingOneChunkData::make(std::clamp(options.chunkBufferCount, 1U, chunkCount),
+                                          device,
+                                          allocator,
+                                          computeQueueFamilyIndex,
+                                          transferQueueFamilyIndex,
+                                          static_cast<vk::DeviceSize>(chunkSize) * sequenceWordCount * sizeof(uint32_t))},
+
+      // Every chunk in flight records up to three regions.
+      profiler{physicalDevice, device, computeQueueFamilyIndex, 3 * static_cast<uint32_t>(chunkData.size())},
+
+      isReadbackProfiled{physicalDevice.getQueueFamilyProperties()[transferQueueFamilyIndex].timestampValidBits ==
+                         physicalDevice.getQueueFamilyProperties()[computeQueueFamilyIndex].timestampValidBits}
 {
     vk::PushConstantRange pushConstantRange{vk::ShaderStageFlagBits::eCompute, 0, sizeof(PushConstants)};
 
@@ -92,19 +89,24 @@ HammingOneGenerator::HammingOneGenerator(uint32_t createCount, uint32_t changeCo
         {0, 0, sizeof(uint32_t)},
         {1, sizeof(uint32_t), sizeof(uint32_t)},
         {2, 2 * sizeof(uint32_t), sizeof(uint32_t)},
-        {3, 3 * sizeof(uint32_t), sizeof(uint32_t)}};
+        {3, 3 * sizeof(uint32_t), sizeof(uint32_t)},
+        {4, 4 * sizeof(uint32_t), sizeof(vk::Bool32)}};
 
-    const std::vector<uint32_t> specializationData{maxWorkGroupSizeX, createCount, changeCount, length};
+    const std::vector<uint32_t> specializationData{maxWorkGroupSizeX,
+                                                   options.createCount,
+                                                   options.changeCount,
+                                                   options.length,
+                                                   options.storage == Storage::ePacked ? vk::True : vk::False};
 
     vk::SpecializationInfo specializationInfo{static_cast<uint32_t>(specializationMapEntries.size()),
                                               specializationMapEntries.data(),
                                               specializationData.size() * sizeof(uint32_t),
                                               specializationData.data()};
 
-    vk::raii::ShaderModule computeShaderModule{glslContext.makeShaderModule(
+    vk::raii::ShaderModule computeShaderModule{glslContext.makeShaderModuleFromFile(
         device,
         vk::ShaderStageFlagBits::eCompute,
-        intvlk::readFile("src/shaders/hamming_one_generator.comp"))};
+        "src/shaders/hamming_one_generator.comp")};
 
     vk::PipelineShaderStageCreateInfo pipelineShaderStageCreateInfo{vk::PipelineShaderStageCreateFlags{},
                                                                     vk::ShaderStageFlagBits::eCompute,
@@ -116,84 +118,214 @@ HammingOneGenerator::HammingOneGenerator(uint32_t createCount, uint32_t changeCo
                                                             pipelineShaderStageCreateInfo,
                                                             computePipelineLayout};
 
-    computePipeline = vk::raii::Pipeline{device, nullptr, computePipelineCreateInfo};
+    computePipeline = vk::raii::Pipeline{device, pipelineCache.get(), computePipelineCreateInfo};
 }
 
-HammingOneGenerator::~HammingOneGenerator()
-{
-    device.waitIdle();
-}
+HammingOneGenerator::HammingOneGenerator(uint32_t createCount,
+                                         uint32_t changeCount,
+                                         uint32_t length,
+                                         Storage storage)
+    : HammingOneGenerator{HammingOneOptions{.createCount = createCount,
+                                            .changeCount = changeCount,
+                                            .length = length,
+                                            .storage = storage}} {}
 
-uint32_t HammingOneGenerator::makeTimeBasedSeed() const
+HammingOneGenerator::~HammingOneGenerator()
 {
-    return static_cast<uint32_t>(
-               std::chrono::high_resolution_clock::now()
-                   .time_since_epoch()
-                   .count()) &
-           ((1 << 23) - 1);
+    transferQueue.waitIdle();
+    computeQueue.waitIdle();
 }
 
-void HammingOneGenerator::writeData(std::string_view filename,
-                                    const uint32_t *data,
-                                    uint32_t createCount,
-                                    uint32_t length) const
+// The create pass runs an invocation per word of a chunk, indexed with 32 bits, in a
+// single row of workgroups, and writes them all through one buffer.
+uint32_t HammingOneGenerator::getMaxChunkSize() const
 {
-    if (std::ofstream file{std::string{filename}})
+    const auto &limits{physicalDevice.getProperties().limits};
+    const uint64_t maxWordCount{std::min({static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()),
+                                          static_cast<uint64_t>(limits.maxComputeWorkGroupCount[0]) * maxWorkGroupSizeX,
+                                          static_cast<uint64_t>(limits.maxStorageBufferRange) / sizeof(uint32_t)})};
+    if (maxWordCount < sequenceWordCount)
     {
-        file << createCount << ' ' << length << '\n';
-        for (uint32_t i{0}; i < createCount; ++i)
-        {
-            for (uint32_t j{0}; j < length; ++j)
-            {
-                file << data[i * length + j];
-            }
-            file << '\n';
-        }
+        throw intvlk::Error{std::format("Sequences of {} bits do not fit into a single dispatch", options.length)};
     }
+    return static_cast<uint32_t>(maxWordCount / sequenceWordCount);
 }
 
-void HammingOneGenerator::run()
+void HammingOneGenerator::recordChunk(HammingOneChunkData &chunkSlot, uint32_t chunk, uint32_t seed)
 {
-    commandBuffer.begin(vk::CommandBufferBeginInfo{});
+    const uint32_t firstSequence{chunk * chunkSize};
+    const uint32_t sequenceCount{std::min(chunkSize, options.createCount - firstSequence)};
+    const uint32_t changeSequenceCount{firstSequence < options.changeCount
+                                           ? std::min(sequenceCount, options.changeCount - firstSequence)
+                                           : 0};
+    const vk::DeviceSize size{static_cast<vk::DeviceSize>(sequenceCount) * sequenceWordCount * sizeof(uint32_t)};
+
+    chunkSlot.commandPool.reset();
+
+    const auto &commandBuffer{chunkSlot.commandBuffer};
+    commandBuffer.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, computePipeline);
-    PushConstants pushConstants{makeTimeBasedSeed(), Algorithm::eCreate, deviceBufferAddress};
+    PushConstants pushConstants{seed,
+                                Algorithm::eCreate,
+                                chunkSlot.deviceBufferAddress,
+                                firstSequence,
+                                sequenceCount};
     commandBuffer.pushConstants<PushConstants>(computePipelineLayout,
                                                vk::ShaderStageFlagBits::eCompute,
                                                0,
                                                pushConstants);
-    commandBuffer.dispatch(createGroupCountX, 1, 1);
+    const uint32_t createRegion{profiler.beginGpuRegion(commandBuffer, "create", size)};
+    commandBuffer.dispatch(static_cast<uint32_t>((static_cast<uint64_t>(sequenceCount) * sequenceWordCount + maxWorkGroupSizeX - 1) /
+                                                 maxWorkGroupSizeX),
+                           1,
+                           1);
+    profiler.endGpuRegion(commandBuffer, createRegion);
     vk::BufferMemoryBarrier2 bufferMemoryBarrier{vk::PipelineStageFlagBits2::eComputeShader,
                                                  vk::AccessFlagBits2::eShaderWrite,
                                                  vk::PipelineStageFlagBits2::eComputeShader,
-                                                 vk::AccessFlagBits2::eShaderRead,
+                                                 vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite,
                                                  computeQueueFamilyIndex,
                                                  computeQueueFamilyIndex,
-                                                 deviceBufferData.buffer,
+                                                 chunkSlot.deviceBufferData.buffer,
                                                  0,
                                                  vk::WholeSize};
-    commandBuffer.pipelineBarrier2(vk::DependencyInfoKHR(vk::DependencyFlags{},
-                                                         {},
-                                                         bufferMemoryBarrier,
-                                                         {}));
-    pushConstants.algorithm = Algorithm::eChange;
-    commandBuffer.pushConstants<PushConstants>(computePipelineLayout,
-                                               vk::ShaderStageFlagBits::eCompute,
-                                               0,
-                                               pushConstants);
-    commandBuffer.dispatch(changeGroupCountX, 1, 1);
+    if (0 < changeSequenceCount)
+    {
+        commandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, {}, bufferMemoryBarrier, {}});
+        pushConstants.algorithm = Algorithm::eChange;
+        commandBuffer.pushConstants<PushConstants>(computePipelineLayout,
+                                                   vk::ShaderStageFlagBits::eCompute,
+                                                   0,
+                                                   pushConstants);
+        const uint32_t changeRegion{profiler.beginGpuRegion(commandBuffer, "change")};
+        commandBuffer.dispatch((changeSequenceCount + maxWorkGroupSizeX - 1) / maxWorkGroupSizeX, 1, 1);
+        profiler.endGpuRegion(commandBuffer, changeRegion);
+    }
+    if (chunkSlot.isReadInPlace())
+    {
+        bufferMemoryBarrier.dstStageMask = vk::PipelineStageFlagBits2::eHost;
+        bufferMemoryBarrier.dstAccessMask = vk::AccessFlagBits2::eHostRead;
+        commandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, {}, bufferMemoryBarrier, {}});
+    }
+    else if (computeQueueFamilyIndex != transferQueueFamilyIndex)
+    {
+        // Releases the chunk to the transfer family, the semaphore wait orders the copy after it.
+        bufferMemoryBarrier.dstStageMask = vk::PipelineStageFlagBits2::eNone;
+        bufferMemoryBarrier.dstAccessMask = vk::AccessFlagBits2::eNone;
+        bufferMemoryBarrier.dstQueueFamilyIndex = transferQueueFamilyIndex;
+        commandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, {}, bufferMemoryBarrier, {}});
+    }
     commandBuffer.end();
-    vk::CommandBufferSubmitInfo commandBufferSubmitInfo{commandBuffer};
-    vk::SubmitInfo2 submitInfo{vk::SubmitFlags{}, {}, commandBufferSubmitInfo, {}};
-    computeQueue.submit2(submitInfo);
-    computeQueue.waitIdle();
-    intvlk::oneTimeSubmit(device,
-                          commandPool,
-                          computeQueue,
-                          [this](const vk::raii::CommandBuffer &cb)
-                          { cb.copyBuffer(
-                                deviceBufferData.buffer,
-                                hostBufferData.buffer,
-                                vk::BufferCopy{0, 0, createGroupCountX * maxWorkGroupSizeX * sizeof(uint32_t)}); });
-    const auto *data{static_cast<const uint32_t *>(hostBufferData.allocationInfo.pMappedData)};
-    writeData("hamming_one.txt", data, createCount, length);
+
+    chunkSlot.submitValue = computeQueue.submit(commandBuffer);
+
+    if (!chunkSlot.isReadInPlace())
+    {
+        recordReadback(chunkSlot, size);
+    }
+}
+
+// The next dispatch into a chunk only starts after its readback has been waited for
+// on the host, and overwrites the whole chunk, so ownership is never transferred back.
+void HammingOneGenerator::recordReadback(HammingOneChunkData &chunkSlot, vk::DeviceSize size)
+{
+    chunkSlot.transferCommandPool.reset();
+
+    const auto &commandBuffer{chunkSlot.transferCommandBuffer};
+    commandBuffer.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+    if (computeQueueFamilyIndex != transferQueueFamilyIndex)
+    {
+        vk::BufferMemoryBarrier2 bufferMemoryBarrier{vk::PipelineStageFlagBits2::eCopy,
+                                                     vk::AccessFlagBits2::eNone,
+                                                     vk::PipelineStageFlagBits2::eCopy,
+                                                     vk::AccessFlagBits2::eTransferRead,
+                                                     computeQueueFamilyIndex,
+                                                     transferQueueFamilyIndex,
+                                                     chunkSlot.deviceBufferData.buffer,
+                                                     0,
+                                                     vk::WholeSize};
+        commandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, {}, bufferMemoryBarrier, {}});
+    }
+    const uint32_t readbackRegion{isReadbackProfiled ? profiler.beginGpuRegion(commandBuffer, "readback", size) : 0};
+    commandBuffer.copyBuffer(chunkSlot.deviceBufferData.buffer,
+                             chunkSlot.hostBufferData.buffer,
+                             vk::BufferCopy{0, 0, size});
+    if (isReadbackProfiled)
+    {
+        profiler.endGpuRegion(commandBuffer, readbackRegion);
+    }
+    vk::BufferMemoryBarrier2 hostBufferMemoryBarrier{vk::PipelineStageFlagBits2::eCopy,
+                                                     vk::AccessFlagBits2::eTransferWrite,
+                                                     vk::PipelineStageFlagBits2::eHost,
+                                                     vk::AccessFlagBits2::eHostRead,
+                                                     transferQueueFamilyIndex,
+                                                     transferQueueFamilyIndex,
+                                                     chunkSlot.hostBufferData.buffer,
+                                                     0,
+                                                     vk::WholeSize};
+    commandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, {}, hostBufferMemoryBarrier, {}});
+    commandBuffer.end();
+
+    // The semaphore wait makes the compute writes visible to the copy.
+    chunkSlot.readbackValue = transferQueue.submit(
+        commandBuffer,
+        computeQueue.makeWaitInfo(chunkSlot.submitValue, vk::PipelineStageFlagBits2::eCopy));
+}
+
+void HammingOneGenerator::run()
+{
+    const uint32_t seed{options.seed ? *options.seed : hamming_one_random::makeTimeBasedSeed()};
+    const auto chunkBufferCount{static_cast<uint32_t>(chunkData.size())};
+
+    HammingOneWriter writer{options, seed};
+
+    // Keep every buffer pair busy: while chunk i is read back and written out,
+    // chunks i + 1 to i + chunkBufferCount - 1 are already being generated.
+    for (uint32_t chunk{0}; chunk < chunkBufferCount; ++chunk)
+    {
+        recordChunk(chunkData[chunk], chunk, seed);
+    }
+    for (uint32_t chunk{0}; chunk < chunkCount; ++chunk)
+    {
+        auto &chunkSlot{chunkData[chunk % chunkBufferCount]};
+        if (chunkSlot.isReadInPlace())
+        {
+            computeQueue.wait(chunkSlot.submitValue);
+        }
+        else
+        {
+            transferQueue.wait(chunkSlot.readbackValue);
+        }
+
+        profiler.collect();
+
+        const uint32_t sequenceCount{std::min(chunkSize, options.createCount - chunk * chunkSize)};
+        const vk::DeviceSize size{static_cast<vk::DeviceSize>(sequenceCount) * sequenceWordCount * sizeof(uint32_t)};
+        const auto &readbackBufferData{chunkSlot.getReadbackBufferData()};
+        vmaInvalidateAllocation(allocator.get(), readbackBufferData.allocation.get(), 0, size);
+        {
+            intvlk::Profiler::CpuScope writeScope{profiler, "write", size};
+            writer.write(static_cast<const uint32_t *>(readbackBufferData.allocationInfo.pMappedData), sequenceCount);
+        }
+
+        if (chunk + chunkBufferCount < chunkCount)
+        {
+            recordChunk(chunkSlot, chunk + chunkBufferCount, seed);
+        }
+    }
+
+    profiler.report(std::cout);
+    if (!options.profileFilename.empty())
+    {
+        profiler.writeJson(options.profileFilename);
+    }
+}
+
+std::unique_ptr<VulkanApp> makeHammingOneGenerator(const HammingOneOptions &options)
+{
+    if (options.backend == Backend::eCpu)
+    {
+        return std::make_unique<HammingOneCpuGenerator>(options);
+    }
+    return std::make_unique<HammingOneGenerator>(options);
 }
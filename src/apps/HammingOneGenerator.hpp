@@ -17,6 +17,10 @@
 
 #include "include.hpp"
 
+#include "HammingOneChunkData.hpp"
+#include "HammingOneOptions.hpp"
+#include "HammingOneRandom.hpp"
+#include "HammingOneWriter.hpp"
 #include "VulkanApp.hpp"
 
 enum class Algorithm : uint32_t
@@ -31,26 +35,34 @@ public:
     uint32_t seed;
     Algorithm algorithm;
     vk::DeviceAddress ssbo;
+    uint32_t firstSequence;
+    uint32_t sequenceCount;
 };
 
 class HammingOneGenerator : public VulkanApp
 {
 public:
-    HammingOneGenerator(uint32_t createCount, uint32_t changeCount, uint32_t length);
+    explicit HammingOneGenerator(const HammingOneOptions &options);
+
+    HammingOneGenerator(uint32_t createCount,
+                        uint32_t changeCount,
+                        uint32_t length,
+                        Storage storage = Storage::ePacked);
 
     ~HammingOneGenerator() override;
 
     void run() override;
 
 private:
-    uint32_t makeTimeBasedSeed() const;
-    void writeData(std::string_view filename, const uint32_t *data, uint32_t createCount, uint32_t length) const;
+    uint32_t getMaxChunkSize() const;
+    void recordChunk(HammingOneChunkData &chunkSlot, uint32_t chunk, uint32_t seed);
+    void recordReadback(HammingOneChunkData &chunkSlot, vk::DeviceSize size);
 
     const std::string appName{"Hamming One Generator"};
+    const float computeQueuePriority{1.0f};
+    const float transferQueuePriority{1.0f};
 
-    uint32_t createCount;
-    uint32_t changeCount;
-    uint32_t length;
+    HammingOneOptions options;
     vk::raii::Context context{};
     vk::raii::Instance instance;
 #if !defined(NDEBUG)
@@ -58,18 +70,27 @@ private:
 #endif
     vk::raii::PhysicalDevice physicalDevice;
     uint32_t maxWorkGroupSizeX;
-    uint32_t createGroupCountX;
-    uint32_t changeGroupCountX;
+    uint32_t sequenceWordCount;
+    // options.getChunkSize(), clamped to what one dispatch and one buffer can hold.
+    uint32_t chunkSize;
+    uint32_t chunkCount;
     uint32_t computeQueueFamilyIndex;
+    uint32_t transferQueueFamilyIndex;
+    std::vector<intvlk::QueueRequest> queueRequests;
+    std::vector<uint32_t> queueIndices;
     vk::raii::Device device;
-    vk::raii::CommandPool commandPool;
-    vk::raii::CommandBuffer commandBuffer;
-    vk::raii::Queue computeQueue;
+    intvlk::TimelineQueue computeQueue;
+    intvlk::TimelineQueue transferQueue;
+    intvlk::PipelineCache pipelineCache;
     std::shared_ptr<VmaAllocator_T> allocator;
-    intvlk::vma_utils::BufferData deviceBufferData;
-    vk::DeviceAddress deviceBufferAddress;
+    std::vector<HammingOneChunkData> chunkData;
+    intvlk::Profiler profiler;
+    // Timestamps of both queues are only comparable when they have the same number of valid bits.
+    bool isReadbackProfiled;
     vk::raii::PipelineLayout computePipelineLayout{VK_NULL_HANDLE};
     intvlk::glslang_utils::GlslangContext glslContext{};
     vk::raii::Pipeline computePipeline{VK_NULL_HANDLE};
-    intvlk::vma_utils::BufferData hostBufferData;
 };
+
+// Creates the generator for options.backend.
+std::unique_ptr<VulkanApp> makeHammingOneGenerator(const HammingOneOptions &options);
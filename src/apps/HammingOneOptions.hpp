@@ -0,0 +1,118 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include <format>
+#include <optional>
+
+enum class Backend : uint32_t
+{
+    eVulkan,
+    eCpu
+};
+
+enum class Storage : uint32_t
+{
+    eUnpacked,
+    ePacked
+};
+
+enum class OutputFormat : uint32_t
+{
+    eText,
+    eBinary
+};
+
+class HammingOneOptions
+{
+public:
+    // Returns the options, so that generators check them before deriving anything from them.
+    const HammingOneOptions &validate() const
+    {
+        if (createCount == 0)
+        {
+            throw intvlk::Error{"The dataset must contain at least one sequence"};
+        }
+        if (length == 0)
+        {
+            throw intvlk::Error{"Sequences must be at least one bit long"};
+        }
+        // The changed sequences duplicate the first ones, which must exist.
+        if (createCount < changeCount)
+        {
+            throw intvlk::Error{std::format("Cannot change {} of {} sequences", changeCount, createCount)};
+        }
+        return *this;
+    }
+
+    uint32_t getSequenceWordCount() const
+    {
+        return storage == Storage::ePacked ? (length + 31) / 32 : length;
+    }
+
+    uint32_t getChunkSize() const
+    {
+        return chunkSize && chunkSize < createCount ? chunkSize : createCount;
+    }
+
+    uint32_t getChunkCount() const
+    {
+        return (createCount + getChunkSize() - 1) / getChunkSize();
+    }
+
+    std::string getOutputFilename() const
+    {
+        if (!outputFilename.empty())
+        {
+            return outputFilename;
+        }
+        return outputFormat == OutputFormat::eBinary ? "hamming_one.bin" : "hamming_one.txt";
+    }
+
+    uint32_t createCount{};
+    uint32_t changeCount{};
+    uint32_t length{};
+    Backend backend{Backend::eVulkan};
+    Storage storage{Storage::ePacked};
+    // Empty picks a time-based seed; the same seed always yields the same dataset.
+    std::optional<uint32_t> seed{};
+    // Sequences generated per dispatch; zero generates the whole dataset at once.
+    uint32_t chunkSize{};
+    // Device and host buffer pairs cycled through while streaming chunks.
+    uint32_t chunkBufferCount{2};
+    OutputFormat outputFormat{OutputFormat::eText};
+    // Empty selects hamming_one.txt or hamming_one.bin depending on the output format.
+    std::string outputFilename{};
+    // Threads formatting text output; zero uses every hardware thread.
+    uint32_t writerThreadCount{};
+    // Threads generating sequences on the CPU backend; zero uses every hardware thread.
+    uint32_t generatorThreadCount{};
+    // Empty skips the JSON dump of the per-stage timings printed after a run.
+    std::string profileFilename{};
+};
+
+class HammingOneSolverOptions
+{
+public:
+    // Text or binary dataset written by a Hamming-one generator.
+    std::string inputFilename{"hamming_one.txt"};
+    std::string outputFilename{"hamming_one_pairs.txt"};
+    Backend backend{Backend::eVulkan};
+    // Threads solving on the CPU backend; zero uses every hardware thread.
+    uint32_t threadCount{};
+};
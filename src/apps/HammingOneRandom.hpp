@@ -0,0 +1,143 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include "HammingOneOptions.hpp"
+
+#include <array>
+#include <chrono>
+
+// Mirrors the generator in hamming_one_generator.comp, so any chunk of a dataset
+// can be reproduced on the CPU from its seed. Both must be changed together.
+namespace hamming_one_random
+{
+    enum class Stream : uint32_t
+    {
+        eCreate,
+        eChange
+    };
+
+    inline constexpr uint32_t philoxM0{0xD2511F53};
+    inline constexpr uint32_t philoxM1{0xCD9E8D57};
+    inline constexpr uint32_t philoxW0{0x9E3779B9};
+    inline constexpr uint32_t philoxW1{0xBB67AE85};
+    // Second key word, fixed so that the seed alone selects the dataset.
+    inline constexpr uint32_t keyTag{0x48414D31};
+
+    inline uint32_t makeTimeBasedSeed()
+    {
+        return static_cast<uint32_t>(
+            std::chrono::high_resolution_clock::now()
+                .time_since_epoch()
+                .count());
+    }
+
+    // Philox4x32-10 from Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3".
+    constexpr std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key)
+    {
+        for (uint32_t i{0}; i < 10; ++i)
+        {
+            if (0 < i)
+            {
+                key[0] += philoxW0;
+                key[1] += philoxW1;
+            }
+            const uint64_t product0{static_cast<uint64_t>(philoxM0) * counter[0]};
+            const uint64_t product1{static_cast<uint64_t>(philoxM1) * counter[2]};
+            counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                       static_cast<uint32_t>(product1),
+                       static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                       static_cast<uint32_t>(product0)};
+        }
+        return counter;
+    }
+
+    // Known-answer vectors of philox4x32_10 from kat_vectors in Random123.
+    static_assert(philox4x32({0, 0, 0, 0}, {0, 0}) ==
+                  std::array<uint32_t, 4>{0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8});
+    static_assert(philox4x32({0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF}, {0xFFFFFFFF, 0xFFFFFFFF}) ==
+                  std::array<uint32_t, 4>{0x408F276D, 0x41C83B0E, 0xA20BC7C6, 0x6D5451FD});
+    static_assert(philox4x32({0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344}, {0xA4093822, 0x299F31D0}) ==
+                  std::array<uint32_t, 4>{0xD16CFE09, 0x94FDCCEB, 0x5001E420, 0x24126EA1});
+
+    // Every (stream, sequence, word) triple is its own counter, so values do not
+    // depend on the order or the chunk in which they are generated.
+    inline uint32_t randomWord(uint32_t seed, Stream stream, uint32_t sequence, uint32_t word)
+    {
+        return philox4x32({word, sequence, static_cast<uint32_t>(stream), 0}, {seed, keyTag})[0];
+    }
+
+    // Packed word of a sequence before the change pass, with the unused bits of the last word cleared.
+    inline uint32_t createWord(uint32_t seed, const HammingOneOptions &options, uint32_t sequence, uint32_t word)
+    {
+        // The last changeCount sequences duplicate the first ones.
+        const uint32_t part{options.createCount - options.changeCount};
+        const uint32_t source{sequence < part ? sequence : sequence - part};
+        const uint32_t tail{options.length % 32};
+        const uint32_t mask{word == (options.length - 1) / 32 && tail != 0 ? (1U << tail) - 1 : ~0U};
+        return randomWord(seed, Stream::eCreate, source, word) & mask;
+    }
+
+    // Bit flipped in one of the first changeCount sequences, uniform over [0, length).
+    inline uint32_t changePosition(uint32_t seed, const HammingOneOptions &options, uint32_t sequence)
+    {
+        return static_cast<uint32_t>(
+            (static_cast<uint64_t>(randomWord(seed, Stream::eChange, sequence, 0)) * options.length) >> 32);
+    }
+
+    // Writes sequenceCount sequences starting at firstSequence in the storage layout of options.
+    inline void generate(uint32_t seed,
+                         const HammingOneOptions &options,
+                         uint32_t firstSequence,
+                         uint32_t sequenceCount,
+                         uint32_t *data)
+    {
+        const uint32_t sequenceWordCount{options.getSequenceWordCount()};
+        for (uint32_t i{0}; i < sequenceCount; ++i)
+        {
+            const uint32_t sequence{firstSequence + i};
+            uint32_t *sequenceData{data + static_cast<size_t>(i) * sequenceWordCount};
+            if (options.storage == Storage::ePacked)
+            {
+                for (uint32_t j{0}; j < sequenceWordCount; ++j)
+                {
+                    sequenceData[j] = createWord(seed, options, sequence, j);
+                }
+            }
+            else
+            {
+                for (uint32_t j{0}; j < options.length; ++j)
+                {
+                    sequenceData[j] = (createWord(seed, options, sequence, j / 32) >> (j % 32)) & 1;
+                }
+            }
+            if (sequence < options.changeCount)
+            {
+                const uint32_t position{changePosition(seed, options, sequence)};
+                if (options.storage == Storage::ePacked)
+                {
+                    sequenceData[position / 32] ^= 1U << (position % 32);
+                }
+                else
+                {
+                    sequenceData[position] ^= 1;
+                }
+            }
+        }
+    }
+}
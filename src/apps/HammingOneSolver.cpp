@@ -0,0 +1,282 @@
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "HammingOneSolver.hpp"
+
+#include "HammingOneCpuSolver.hpp"
+
+#include <chrono>
+#include <format>
+#include <iostream>
+
+HammingOneSolver::HammingOneSolver(const HammingOneSolverOptions &options)
+    : options{options},
+
+      dataset{options.inputFilename},
+
+      tableSize{dataset.getHashTableSize()},
+
+      instance{intvlk::makeInstance(context,
+                                    appName,
+                                    "No Engine",
+                                    {},
+                                    {},
+                                    vk::ApiVersion13,
+                                    nullptr)},
+
+#if !defined(NDEBUG)
+      debugUtilsMessenger{instance, intvlk::makeDebugUtilsMessengerCreateInfo()},
+#endif
+
+      physicalDevice{intvlk::findPhysicalDevice(instance)},
+
+      maxWorkGroupSizeX{physicalDevice.getProperties().limits.maxComputeWorkGroupSize[0]},
+
+      computeQueueFamilyIndex{intvlk::findQueueFamilyIndex(physicalDevice, vk::QueueFlagBits::eCompute)},
+
+      device{intvlk::makeDevice(physicalDevice, {}, computeQueueFamilyIndex)},
+
+      computeQueue{device, computeQueueFamilyIndex, 0},
+
+      pipelineCache{physicalDevice, device, "hamming_one_solver.pipeline_cache"},
+
+      allocator{intvlk::vma_utils::makeAllocator(VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT,
+                                                 physicalDevice,
+                                                 device,
+                                                 instance,
+                                                 vk::ApiVersion13)},
+
+      commandPool{device, vk::CommandPoolCreateInfo{vk::CommandPoolCreateFlags{}, computeQueueFamilyIndex}},
+
+      sequenceBufferData{makeStorageBuffer(dataset.data.size() * sizeof(uint32_t))},
+
+      hashBufferData{makeStorageBuffer(static_cast<vk::DeviceSize>(dataset.count) * 2 * sizeof(uint32_t))},
+
+      tableBufferData{makeStorageBuffer(static_cast<vk::DeviceSize>(tableSize) * sizeof(uint32_t))}
+{
+    // Every pass dispatches a column of workgroups per group of sequences and, at most,
+    // a row per word of a sequence.
+    const auto &maxComputeWorkGroupCount{physicalDevice.getProperties().limits.maxComputeWorkGroupCount};
+    if (maxComputeWorkGroupCount[0] < (static_cast<uint64_t>(dataset.count) + maxWorkGroupSizeX - 1) / maxWorkGroupSizeX)
+    {
+        throw intvlk::Error{"The dataset has too many sequences for the device"};
+    }
+    if (maxComputeWorkGroupCount[1] < dataset.wordCount)
+    {
+        throw intvlk::Error{"Sequences are too long for the device"};
+    }
+
+    {
+        // The dataset is uploaded once, so the staging ring is released right after.
+        intvlk::vma_utils::UploadContext uploadContext{
+            device,
+            allocator,
+            computeQueue,
+            computeQueue,
+            std::min<vk::DeviceSize>(dataset.data.size() * sizeof(uint32_t), 64 << 20)};
+        uploadContext.upload(sequenceBufferData, dataset.data);
+    }
+
+    vk::PushConstantRange pushConstantRange{vk::ShaderStageFlagBits::eCompute,
+                                            0,
+                                            sizeof(HammingOneSolverPushConstants)};
+
+    computePipelineLayout = vk::raii::PipelineLayout{
+        device,
+        vk::PipelineLayoutCreateInfo{vk::PipelineLayoutCreateFlags{}, {}, pushConstantRange}};
+
+    const std::vector<vk::SpecializationMapEntry> specializationMapEntries{
+        {0, 0, sizeof(uint32_t)},
+        {1, sizeof(uint32_t), sizeof(uint32_t)},
+        {2, 2 * sizeof(uint32_t), sizeof(uint32_t)},
+        {3, 3 * sizeof(uint32_t), sizeof(uint32_t)}};
+
+    const std::vector<uint32_t> specializationData{maxWorkGroupSizeX,
+                                                   dataset.count,
+                                                   dataset.length,
+                                                   tableSize};
+
+    vk::SpecializationInfo specializationInfo{static_cast<uint32_t>(specializationMapEntries.size()),
+                                              specializationMapEntries.data(),
+                                              specializationData.size() * sizeof(uint32_t),
+                                              specializationData.data()};
+
+    vk::raii::ShaderModule computeShaderModule{glslContext.makeShaderModuleFromFile(
+        device,
+        vk::ShaderStageFlagBits::eCompute,
+        "src/shaders/hamming_one_solver.comp")};
+
+    vk::PipelineShaderStageCreateInfo pipelineShaderStageCreateInfo{vk::PipelineShaderStageCreateFlags{},
+                                                                    vk::ShaderStageFlagBits::eCompute,
+                                                                    computeShaderModule,
+                                                                    "main",
+                                                                    &specializationInfo};
+
+    vk::ComputePipelineCreateInfo computePipelineCreateInfo{vk::PipelineCreateFlags{},
+                                                            pipelineShaderStageCreateInfo,
+                                                            computePipelineLayout};
+
+    computePipeline = vk::raii::Pipeline{device, pipelineCache.get(), computePipelineCreateInfo};
+}
+
+HammingOneSolver::~HammingOneSolver()
+{
+    computeQueue.waitIdle();
+}
+
+intvlk::vma_utils::BufferData HammingOneSolver::makeStorageBuffer(vk::DeviceSize size) const
+{
+    return intvlk::vma_utils::BufferData{device,
+                                         allocator,
+                                         size,
+                                         vk::BufferUsageFlagBits::eStorageBuffer |
+                                             vk::BufferUsageFlagBits::eTransferSrc |
+                                             vk::BufferUsageFlagBits::eTransferDst |
+                                             vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                                         VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                                         {},
+                                         VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                                             VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                                             VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT};
+}
+
+void HammingOneSolver::recordSolve(const vk::raii::CommandBuffer &commandBuffer,
+                                   HammingOneSolverPushConstants pushConstants,
+                                   const intvlk::vma_utils::BufferData &pairBufferData,
+                                   const intvlk::vma_utils::BufferData &hostPairBufferData,
+                                   vk::DeviceSize pairBufferSize) const
+{
+    const auto barrier{[&commandBuffer](vk::PipelineStageFlags2 srcStageMask,
+                                        vk::AccessFlags2 srcAccessMask,
+                                        vk::PipelineStageFlags2 dstStageMask,
+                                        vk::AccessFlags2 dstAccessMask)
+                       {
+                           vk::MemoryBarrier2 memoryBarrier{srcStageMask, srcAccessMask, dstStageMask, dstAccessMask};
+                           commandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, memoryBarrier});
+                       }};
+    const auto dispatch{[this, &commandBuffer, &pushConstants](HammingOneSolverPass pass, uint32_t groupCountY)
+                        {
+                            pushConstants.pass = pass;
+                            commandBuffer.pushConstants<HammingOneSolverPushConstants>(
+                                computePipelineLayout,
+                                vk::ShaderStageFlagBits::eCompute,
+                                0,
+                                pushConstants);
+                            commandBuffer.dispatch((dataset.count + maxWorkGroupSizeX - 1) / maxWorkGroupSizeX,
+                                                   groupCountY,
+                                                   1);
+                        }};
+    const vk::AccessFlags2 shaderReadWrite{vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite};
+
+    commandBuffer.fillBuffer(tableBufferData.buffer, 0, vk::WholeSize, 0xFFFFFFFF);
+    commandBuffer.fillBuffer(pairBufferData.buffer, 0, sizeof(uint32_t), 0);
+    barrier(vk::PipelineStageFlagBits2::eClear,
+            vk::AccessFlagBits2::eTransferWrite,
+            vk::PipelineStageFlagBits2::eComputeShader,
+            shaderReadWrite);
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, computePipeline);
+    dispatch(HammingOneSolverPass::eHash, 1);
+    barrier(vk::PipelineStageFlagBits2::eComputeShader,
+            vk::AccessFlagBits2::eShaderWrite,
+            vk::PipelineStageFlagBits2::eComputeShader,
+            shaderReadWrite);
+    dispatch(HammingOneSolverPass::eInsert, 1);
+    barrier(vk::PipelineStageFlagBits2::eComputeShader,
+            vk::AccessFlagBits2::eShaderWrite,
+            vk::PipelineStageFlagBits2::eComputeShader,
+            shaderReadWrite);
+    dispatch(HammingOneSolverPass::eProbe, dataset.wordCount);
+    barrier(vk::PipelineStageFlagBits2::eComputeShader,
+            vk::AccessFlagBits2::eShaderWrite,
+            vk::PipelineStageFlagBits2::eCopy,
+            vk::AccessFlagBits2::eTransferRead);
+
+    commandBuffer.copyBuffer(pairBufferData.buffer, hostPairBufferData.buffer, vk::BufferCopy{0, 0, pairBufferSize});
+    barrier(vk::PipelineStageFlagBits2::eCopy,
+            vk::AccessFlagBits2::eTransferWrite,
+            vk::PipelineStageFlagBits2::eHost,
+            vk::AccessFlagBits2::eHostRead);
+}
+
+void HammingOneSolver::run()
+{
+    const auto startTime{std::chrono::high_resolution_clock::now()};
+
+    HammingOneSolverPushConstants pushConstants{
+        HammingOneSolverPass::eHash,
+        dataset.count,
+        device.getBufferAddress(vk::BufferDeviceAddressInfo{sequenceBufferData.buffer}),
+        device.getBufferAddress(vk::BufferDeviceAddressInfo{hashBufferData.buffer}),
+        device.getBufferAddress(vk::BufferDeviceAddressInfo{tableBufferData.buffer}),
+        // Generated datasets hold at most one pair per sequence, unless sequences repeat.
+        dataset.count};
+
+    // The pair count is only known afterwards, so a run that overflows the pair
+    // buffer is repeated once with a buffer of the reported size.
+    std::vector<HammingOnePair> pairs{};
+    while (true)
+    {
+        // The pair count is followed by the pairs, which start 8 bytes in.
+        const vk::DeviceSize pairBufferSize{2 * sizeof(uint32_t) +
+                                            static_cast<vk::DeviceSize>(pushConstants.pairCapacity) *
+                                                sizeof(HammingOnePair)};
+        intvlk::vma_utils::BufferData pairBufferData{makeStorageBuffer(pairBufferSize)};
+        intvlk::vma_utils::BufferData hostPairBufferData{device,
+                                                         allocator,
+                                                         pairBufferSize,
+                                                         vk::BufferUsageFlagBits::eTransferDst,
+                                                         VMA_MEMORY_USAGE_AUTO,
+                                                         {},
+                                                         VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT};
+        pushConstants.pairs = device.getBufferAddress(vk::BufferDeviceAddressInfo{pairBufferData.buffer});
+
+        intvlk::oneTimeSubmit(device,
+                              commandPool,
+                              computeQueue,
+                              [&](const vk::raii::CommandBuffer &commandBuffer)
+                              { recordSolve(commandBuffer, pushConstants, pairBufferData, hostPairBufferData, pairBufferSize); });
+
+        vmaInvalidateAllocation(allocator.get(), hostPairBufferData.allocation.get(), 0, pairBufferSize);
+        const auto *pairData{static_cast<const uint32_t *>(hostPairBufferData.allocationInfo.pMappedData)};
+        const uint32_t pairCount{pairData[0]};
+        if (pairCount <= pushConstants.pairCapacity)
+        {
+            const auto *first{reinterpret_cast<const HammingOnePair *>(pairData + 2)};
+            pairs.assign(first, first + pairCount);
+            break;
+        }
+        pushConstants.pairCapacity = pairCount;
+    }
+    // Pairs arrive in no particular order from the GPU.
+    std::sort(pairs.begin(), pairs.end());
+
+    const std::chrono::duration<double> elapsedTime{std::chrono::high_resolution_clock::now() - startTime};
+    writeHammingOnePairs(options.outputFilename, pairs);
+    std::cout << std::format("Found {} pairs among {} sequences of {} bits in {:.3f} s\n",
+                             pairs.size(),
+                             dataset.count,
+                             dataset.length,
+                             elapsedTime.count());
+}
+
+std::unique_ptr<VulkanApp> makeHammingOneSolver(const HammingOneSolverOptions &options)
+{
+    if (options.backend == Backend::eCpu)
+    {
+        return std::make_unique<HammingOneCpuSolver>(options);
+    }
+    return std::make_unique<HammingOneSolver>(options);
+}
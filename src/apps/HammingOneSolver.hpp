@@ -0,0 +1,91 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "include.hpp"
+
+#include "HammingOneDataset.hpp"
+#include "HammingOneOptions.hpp"
+#include "VulkanApp.hpp"
+
+enum class HammingOneSolverPass : uint32_t
+{
+    eHash,
+    eInsert,
+    eProbe
+};
+
+class HammingOneSolverPushConstants
+{
+public:
+    HammingOneSolverPass pass;
+    uint32_t pairCapacity;
+    vk::DeviceAddress sequences;
+    vk::DeviceAddress hashes;
+    vk::DeviceAddress table;
+    vk::DeviceAddress pairs;
+};
+
+// Finds every pair of sequences at Hamming distance one. Each sequence gets a
+// 64-bit hash that changes by a fixed key per flipped bit, the hashes go into an
+// open-addressing table, and every sequence looks up its hash with each single
+// bit flipped. Hits are checked against the sequences before they are reported.
+class HammingOneSolver : public VulkanApp
+{
+public:
+    explicit HammingOneSolver(const HammingOneSolverOptions &options);
+
+    ~HammingOneSolver() override;
+
+    void run() override;
+
+private:
+    intvlk::vma_utils::BufferData makeStorageBuffer(vk::DeviceSize size) const;
+    void recordSolve(const vk::raii::CommandBuffer &commandBuffer,
+                     HammingOneSolverPushConstants pushConstants,
+                     const intvlk::vma_utils::BufferData &pairBufferData,
+                     const intvlk::vma_utils::BufferData &hostPairBufferData,
+                     vk::DeviceSize pairBufferSize) const;
+
+    const std::string appName{"Hamming One Solver"};
+
+    HammingOneSolverOptions options;
+    HammingOneDataset dataset;
+    uint32_t tableSize;
+    vk::raii::Context context{};
+    vk::raii::Instance instance;
+#if !defined(NDEBUG)
+    vk::raii::DebugUtilsMessengerEXT debugUtilsMessenger;
+#endif
+    vk::raii::PhysicalDevice physicalDevice;
+    uint32_t maxWorkGroupSizeX;
+    uint32_t computeQueueFamilyIndex;
+    vk::raii::Device device;
+    intvlk::TimelineQueue computeQueue;
+    intvlk::PipelineCache pipelineCache;
+    std::shared_ptr<VmaAllocator_T> allocator;
+    vk::raii::CommandPool commandPool;
+    intvlk::vma_utils::BufferData sequenceBufferData;
+    intvlk::vma_utils::BufferData hashBufferData;
+    intvlk::vma_utils::BufferData tableBufferData;
+    vk::raii::PipelineLayout computePipelineLayout{VK_NULL_HANDLE};
+    intvlk::glslang_utils::GlslangContext glslContext{};
+    vk::raii::Pipeline computePipeline{VK_NULL_HANDLE};
+};
+
+// Creates the solver for options.backend.
+std::unique_ptr<VulkanApp> makeHammingOneSolver(const HammingOneSolverOptions &options);
@@ -0,0 +1,180 @@
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "HammingOneWriter.hpp"
+
+#include <deque>
+
+namespace
+{
+    // Every byte of a packed sequence expands to eight '0' and '1' characters,
+    // least significant bit first, so whole bytes are converted with one copy.
+    constexpr std::array<std::array<char, 8>, 256> makeBitCharacters()
+    {
+        std::array<std::array<char, 8>, 256> bitCharacters{};
+        for (uint32_t i{0}; i < bitCharacters.size(); ++i)
+        {
+            for (uint32_t j{0}; j < 8; ++j)
+            {
+                bitCharacters[i][j] = static_cast<char>('0' + ((i >> j) & 1));
+            }
+        }
+        return bitCharacters;
+    }
+
+    constexpr std::array<std::array<char, 8>, 256> bitCharacters{makeBitCharacters()};
+}
+
+HammingOneWriter::HammingOneWriter(const HammingOneOptions &options, uint32_t seed)
+    : filename{options.getOutputFilename()},
+
+      outputFormat{options.outputFormat},
+
+      storage{options.storage},
+
+      length{options.length},
+
+      sequenceWordCount{options.getSequenceWordCount()},
+
+      packedWordCount{(options.length + 31) / 32},
+
+      threadPool{options.outputFormat == OutputFormat::eText ? options.writerThreadCount : 1}
+{
+    if (outputFormat == OutputFormat::eBinary)
+    {
+        // Chunks are handed to the file in one call straight from mapped memory,
+        // so the stream buffer would only add a copy.
+        file.rdbuf()->pubsetbuf(nullptr, 0);
+        file.open(filename, std::ios::binary);
+    }
+    else
+    {
+        file.open(filename);
+    }
+    if (!file)
+    {
+        throw intvlk::Error{"Failed to open file: " + filename};
+    }
+
+    if (outputFormat == OutputFormat::eBinary)
+    {
+        HammingOneHeader header{};
+        header.count = options.createCount;
+        header.length = length;
+        header.wordCount = packedWordCount;
+        header.seed = seed;
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+    else
+    {
+        file << options.createCount << ' ' << length << '\n';
+    }
+}
+
+void HammingOneWriter::write(const uint32_t *data, uint32_t sequenceCount)
+{
+    if (outputFormat == OutputFormat::eBinary)
+    {
+        writeBinary(data, sequenceCount);
+    }
+    else
+    {
+        writeText(data, sequenceCount);
+    }
+    if (!file)
+    {
+        throw intvlk::Error{"Failed to write file: " + filename};
+    }
+}
+
+void HammingOneWriter::writeBinary(const uint32_t *data, uint32_t sequenceCount)
+{
+    const size_t wordCount{static_cast<size_t>(sequenceCount) * packedWordCount};
+    if (storage == Storage::eUnpacked)
+    {
+        packedData.assign(wordCount, 0);
+        for (size_t i{0}; i < sequenceCount; ++i)
+        {
+            const uint32_t *sequence{data + i * sequenceWordCount};
+            uint32_t *packedSequence{packedData.data() + i * packedWordCount};
+            for (uint32_t j{0}; j < length; ++j)
+            {
+                packedSequence[j / 32] |= (sequence[j] & 1) << (j % 32);
+            }
+        }
+        data = packedData.data();
+    }
+    file.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(wordCount * sizeof(uint32_t)));
+}
+
+void HammingOneWriter::writeText(const uint32_t *data, uint32_t sequenceCount)
+{
+    // Blocks are formatted concurrently and written in order. The number of blocks
+    // in flight is bounded so that memory use does not grow with the chunk size.
+    const uint32_t blockSequenceCount{
+        static_cast<uint32_t>(std::max<size_t>(1, textBlockSize / (static_cast<size_t>(length) + 1)))};
+    const size_t maxPendingBlockCount{2 * static_cast<size_t>(threadPool.getThreadCount())};
+    std::deque<std::future<std::string>> pendingBlocks{};
+    for (uint32_t first{0}; first < sequenceCount; first += blockSequenceCount)
+    {
+        if (pendingBlocks.size() == maxPendingBlockCount)
+        {
+            const std::string block{pendingBlocks.front().get()};
+            file.write(block.data(), static_cast<std::streamsize>(block.size()));
+            pendingBlocks.pop_front();
+        }
+        const uint32_t count{std::min(blockSequenceCount, sequenceCount - first)};
+        const uint32_t *blockData{data + static_cast<size_t>(first) * sequenceWordCount};
+        pendingBlocks.emplace_back(threadPool.submit([this, blockData, count]
+                                                     { return formatText(blockData, count); }));
+    }
+    for (auto &pendingBlock : pendingBlocks)
+    {
+        const std::string block{pendingBlock.get()};
+        file.write(block.data(), static_cast<std::streamsize>(block.size()));
+    }
+}
+
+std::string HammingOneWriter::formatText(const uint32_t *data, uint32_t sequenceCount) const
+{
+    const size_t rowSize{static_cast<size_t>(length) + 1};
+    std::string block(sequenceCount * rowSize, '\n');
+    for (size_t i{0}; i < sequenceCount; ++i)
+    {
+        const uint32_t *sequence{data + i * sequenceWordCount};
+        char *row{block.data() + i * rowSize};
+        if (storage == Storage::ePacked)
+        {
+            const auto *bytes{reinterpret_cast<const uint8_t *>(sequence)};
+            const uint32_t byteCount{length / 8};
+            for (uint32_t j{0}; j < byteCount; ++j)
+            {
+                memcpy(row + 8 * j, bitCharacters[bytes[j]].data(), 8);
+            }
+            for (uint32_t j{8 * byteCount}; j < length; ++j)
+            {
+                row[j] = static_cast<char>('0' + ((sequence[j / 32] >> (j % 32)) & 1));
+            }
+        }
+        else
+        {
+            for (uint32_t j{0}; j < length; ++j)
+            {
+                row[j] = static_cast<char>('0' + sequence[j]);
+            }
+        }
+    }
+    return block;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include "HammingOneOptions.hpp"
+
+#include <fstream>
+
+// Binary files start with this header, followed by count sequences of wordCount
+// little-endian words each. Bit j of a sequence is bit j % 32 of word j / 32 and
+// the unused bits of the last word are zero.
+class HammingOneHeader
+{
+public:
+    static constexpr std::array<char, 4> expectedMagic{'H', 'A', 'M', '1'};
+    static constexpr uint32_t currentVersion{1};
+
+    std::array<char, 4> magic{expectedMagic};
+    uint32_t version{currentVersion};
+    uint32_t headerSize{32};
+    uint32_t count{};
+    uint32_t length{};
+    uint32_t wordCount{};
+    uint32_t seed{};
+    uint32_t reserved{};
+};
+
+static_assert(sizeof(HammingOneHeader) == 32);
+
+class HammingOneWriter
+{
+public:
+    HammingOneWriter(const HammingOneOptions &options, uint32_t seed);
+
+    void write(const uint32_t *data, uint32_t sequenceCount);
+
+private:
+    void writeBinary(const uint32_t *data, uint32_t sequenceCount);
+    void writeText(const uint32_t *data, uint32_t sequenceCount);
+    std::string formatText(const uint32_t *data, uint32_t sequenceCount) const;
+
+    // Rows are formatted in blocks of about this many bytes.
+    static constexpr size_t textBlockSize{1 << 20};
+
+    std::string filename;
+    OutputFormat outputFormat;
+    Storage storage;
+    uint32_t length;
+    uint32_t sequenceWordCount;
+    uint32_t packedWordCount;
+    std::vector<uint32_t> packedData{};
+    std::ofstream file{};
+    intvlk::ThreadPool threadPool;
+};
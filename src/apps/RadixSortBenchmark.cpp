@@ -0,0 +1,296 @@
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "RadixSortBenchmark.hpp"
+
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <numeric>
+
+namespace
+{
+    std::vector<uint32_t> makeRandomKeys(uint32_t keyCount)
+    {
+        std::vector<uint32_t> keys(keyCount);
+        uint64_t state{0x853C49E6748FEA9B};
+        for (auto &key : keys)
+        {
+            // SplitMix64
+            uint64_t z{state += 0x9E3779B97F4A7C15};
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            key = static_cast<uint32_t>((z ^ (z >> 31)) >> 32);
+        }
+        return keys;
+    }
+}
+
+RadixSortBenchmark::RadixSortBenchmark(uint32_t minKeyCount,
+                                       uint32_t maxKeyCount,
+                                       bool withPayloads,
+                                       uint32_t iterationCount)
+    : minKeyCount{std::max(1U, minKeyCount)},
+
+      withPayloads{withPayloads},
+
+      iterationCount{std::max(1U, iterationCount)},
+
+      instance{intvlk::makeInstance(context,
+                                    appName,
+                                    "No Engine",
+                                    {},
+                                    {},
+                                    vk::ApiVersion13,
+                                    nullptr)},
+
+#if !defined(NDEBUG)
+      debugUtilsMessenger{instance, intvlk::makeDebugUtilsMessengerCreateInfo()},
+#endif
+
+      physicalDevice{intvlk::findPhysicalDevice(instance)},
+
+      gpuSupported{intvlk::RadixSort::isSupported(physicalDevice)},
+
+      maxKeyCount{gpuSupported ? findMaxKeyCount(physicalDevice, maxKeyCount, withPayloads) : maxKeyCount},
+
+      computeQueueFamilyIndex{intvlk::findQueueFamilyIndex(physicalDevice, vk::QueueFlagBits::eCompute)},
+
+      device{intvlk::makeDevice(physicalDevice, {}, computeQueueFamilyIndex)},
+
+      computeQueue{device, computeQueueFamilyIndex, 0},
+
+      pipelineCache{physicalDevice, device, "radix_sort_benchmark.pipeline_cache"},
+
+      allocator{intvlk::vma_utils::makeAllocator(VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT,
+                                                 physicalDevice,
+                                                 device,
+                                                 instance,
+                                                 vk::ApiVersion13)},
+
+      commandPool{device,
+                  vk::CommandPoolCreateInfo{vk::CommandPoolCreateFlagBits::eResetCommandBuffer, computeQueueFamilyIndex}},
+
+      commandBuffer{intvlk::makeCommandBuffer(device, commandPool)},
+
+      uploadContext{device, allocator, computeQueue, computeQueue},
+
+      // The GPU buffers are only needed when the device can run the sort.
+      sourceBufferData{makeStorageBuffer(gpuSupported ? (withPayloads ? 2ULL : 1ULL) * this->maxKeyCount * sizeof(uint32_t)
+                                                      : sizeof(uint32_t))},
+
+      keyBufferData{makeStorageBuffer(gpuSupported ? static_cast<vk::DeviceSize>(this->maxKeyCount) * sizeof(uint32_t)
+                                                   : sizeof(uint32_t))},
+
+      payloadBufferData{makeStorageBuffer(gpuSupported && withPayloads
+                                              ? static_cast<vk::DeviceSize>(this->maxKeyCount) * sizeof(uint32_t)
+                                              : sizeof(uint32_t))}
+{
+    if (gpuSupported)
+    {
+        radixSort.emplace(physicalDevice,
+                          device,
+                          allocator,
+                          glslContext,
+                          pipelineCache.get(),
+                          this->maxKeyCount,
+                          withPayloads);
+    }
+}
+
+RadixSortBenchmark::~RadixSortBenchmark()
+{
+    computeQueue.waitIdle();
+}
+
+uint32_t RadixSortBenchmark::findMaxKeyCount(const vk::raii::PhysicalDevice &physicalDevice,
+                                             uint32_t maxKeyCount,
+                                             bool withPayloads)
+{
+    // Keys and payloads live in a source, a working and a temporary buffer each,
+    // and the readback for verification goes through host memory.
+    const vk::DeviceSize bytesPerKey{(withPayloads ? 6 : 3) * sizeof(uint32_t)};
+    const auto properties{physicalDevice.getProperties2<vk::PhysicalDeviceProperties2,
+                                                        vk::PhysicalDeviceVulkan13Properties>()};
+    const vk::DeviceSize maxBufferSize{properties.get<vk::PhysicalDeviceVulkan13Properties>().maxBufferSize};
+    const auto memoryProperties{physicalDevice.getMemoryProperties()};
+    vk::DeviceSize deviceLocalSize{0};
+    for (uint32_t i{0}; i < memoryProperties.memoryHeapCount; ++i)
+    {
+        if (memoryProperties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal)
+        {
+            deviceLocalSize = std::max(deviceLocalSize, memoryProperties.memoryHeaps[i].size);
+        }
+    }
+    // Leave a quarter of the heap for everything else.
+    const vk::DeviceSize fittingKeyCount{std::min(deviceLocalSize / 4 * 3 / bytesPerKey,
+                                                  maxBufferSize / (2 * sizeof(uint32_t)))};
+    return static_cast<uint32_t>(std::min<vk::DeviceSize>(maxKeyCount, fittingKeyCount));
+}
+
+intvlk::vma_utils::BufferData RadixSortBenchmark::makeStorageBuffer(vk::DeviceSize size) const
+{
+    return intvlk::vma_utils::BufferData{device,
+                                         allocator,
+                                         size,
+                                         vk::BufferUsageFlagBits::eStorageBuffer |
+                                             vk::BufferUsageFlagBits::eTransferSrc |
+                                             vk::BufferUsageFlagBits::eTransferDst |
+                                             vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                                         VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                                         {},
+                                         VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                                             VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                                             VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT};
+}
+
+double RadixSortBenchmark::sortOnGpu(const std::vector<uint32_t> &keys)
+{
+    const auto keyCount{static_cast<uint32_t>(keys.size())};
+    const vk::DeviceSize size{static_cast<vk::DeviceSize>(keyCount) * sizeof(uint32_t)};
+
+    // Payloads are the original positions, which lets the result be checked against the input.
+    std::vector<uint32_t> source{keys};
+    if (withPayloads)
+    {
+        source.resize(2 * static_cast<size_t>(keyCount));
+        std::iota(source.begin() + keyCount, source.end(), 0U);
+    }
+    uploadContext.upload(sourceBufferData, source);
+    uploadContext.flush();
+
+    const vk::DeviceAddress keyBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{keyBufferData.buffer})};
+    const vk::DeviceAddress payloadBufferAddress{
+        withPayloads ? device.getBufferAddress(vk::BufferDeviceAddressInfo{payloadBufferData.buffer}) : 0};
+
+    double bestTime{std::numeric_limits<double>::max()};
+    for (uint32_t iteration{0}; iteration < iterationCount; ++iteration)
+    {
+        intvlk::oneTimeSubmit(device,
+                              commandPool,
+                              computeQueue,
+                              [&](const vk::raii::CommandBuffer &copyCommandBuffer)
+                              {
+                                  copyCommandBuffer.copyBuffer(sourceBufferData.buffer,
+                                                               keyBufferData.buffer,
+                                                               vk::BufferCopy{0, 0, size});
+                                  if (withPayloads)
+                                  {
+                                      copyCommandBuffer.copyBuffer(sourceBufferData.buffer,
+                                                                   payloadBufferData.buffer,
+                                                                   vk::BufferCopy{size, 0, size});
+                                  }
+                              });
+
+        commandBuffer.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+        // The sort reads and writes the copies in place, see RadixSort::record.
+        vk::MemoryBarrier2 memoryBarrier{vk::PipelineStageFlagBits2::eCopy,
+                                         vk::AccessFlagBits2::eTransferWrite,
+                                         vk::PipelineStageFlagBits2::eComputeShader,
+                                         vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite};
+        commandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, memoryBarrier});
+        radixSort->record(commandBuffer, keyBufferAddress, payloadBufferAddress, keyCount);
+        commandBuffer.end();
+
+        const auto startTime{std::chrono::high_resolution_clock::now()};
+        computeQueue.wait(computeQueue.submit(commandBuffer));
+        const std::chrono::duration<double> elapsedTime{std::chrono::high_resolution_clock::now() - startTime};
+        bestTime = std::min(bestTime, elapsedTime.count());
+        commandBuffer.reset();
+    }
+
+    intvlk::vma_utils::BufferData hostBufferData{device,
+                                                 allocator,
+                                                 (withPayloads ? 2 : 1) * size,
+                                                 vk::BufferUsageFlagBits::eTransferDst,
+                                                 VMA_MEMORY_USAGE_AUTO,
+                                                 {},
+                                                 VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT};
+    intvlk::oneTimeSubmit(device,
+                          commandPool,
+                          computeQueue,
+                          [&](const vk::raii::CommandBuffer &copyCommandBuffer)
+                          {
+                              vk::MemoryBarrier2 memoryBarrier{vk::PipelineStageFlagBits2::eComputeShader,
+                                                               vk::AccessFlagBits2::eShaderWrite,
+                                                               vk::PipelineStageFlagBits2::eCopy,
+                                                               vk::AccessFlagBits2::eTransferRead};
+                              copyCommandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, memoryBarrier});
+                              copyCommandBuffer.copyBuffer(keyBufferData.buffer,
+                                                           hostBufferData.buffer,
+                                                           vk::BufferCopy{0, 0, size});
+                              if (withPayloads)
+                              {
+                                  copyCommandBuffer.copyBuffer(payloadBufferData.buffer,
+                                                               hostBufferData.buffer,
+                                                               vk::BufferCopy{0, size, size});
+                              }
+                          });
+    vmaInvalidateAllocation(allocator.get(), hostBufferData.allocation.get(), 0, vk::WholeSize);
+
+    const auto *sortedKeys{static_cast<const uint32_t *>(hostBufferData.allocationInfo.pMappedData)};
+    std::vector<uint32_t> expectedKeys{keys};
+    std::sort(expectedKeys.begin(), expectedKeys.end());
+    if (!std::equal(expectedKeys.begin(), expectedKeys.end(), sortedKeys))
+    {
+        throw intvlk::Error{"Radix sort produced wrong keys"};
+    }
+    if (withPayloads)
+    {
+        const uint32_t *payloads{sortedKeys + keyCount};
+        for (uint32_t i{0}; i < keyCount; ++i)
+        {
+            const bool stable{i == 0 || sortedKeys[i - 1] != sortedKeys[i] || payloads[i - 1] < payloads[i]};
+            if (keys[payloads[i]] != sortedKeys[i] || !stable)
+            {
+                throw intvlk::Error{"Radix sort produced wrong payloads"};
+            }
+        }
+    }
+    return bestTime;
+}
+
+double RadixSortBenchmark::sortOnCpu(const std::vector<uint32_t> &keys) const
+{
+    double bestTime{std::numeric_limits<double>::max()};
+    for (uint32_t iteration{0}; iteration < iterationCount; ++iteration)
+    {
+        std::vector<uint32_t> sortedKeys{keys};
+        std::vector<uint32_t> payloads(withPayloads ? keys.size() : 0);
+        std::iota(payloads.begin(), payloads.end(), 0U);
+        const auto startTime{std::chrono::high_resolution_clock::now()};
+        intvlk::RadixSort::sortOnCpu(sortedKeys, payloads);
+        const std::chrono::duration<double> elapsedTime{std::chrono::high_resolution_clock::now() - startTime};
+        bestTime = std::min(bestTime, elapsedTime.count());
+    }
+    return bestTime;
+}
+
+void RadixSortBenchmark::run()
+{
+    std::cout << std::format("{} radix sort of 32-bit keys{}, best of {} runs\n",
+                             gpuSupported ? "GPU" : "CPU fallback",
+                             withPayloads ? " with payloads" : "",
+                             iterationCount);
+    for (uint64_t keyCount{minKeyCount}; keyCount <= maxKeyCount; keyCount *= 4)
+    {
+        const std::vector<uint32_t> keys{makeRandomKeys(static_cast<uint32_t>(keyCount))};
+        const double time{gpuSupported ? sortOnGpu(keys) : sortOnCpu(keys)};
+        std::cout << std::format("{:>11} keys: {:10.3f} ms, {:8.3f} Gkeys/s\n",
+                                 keyCount,
+                                 time * 1e3,
+                                 static_cast<double>(keyCount) / time * 1e-9);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "include.hpp"
+
+#include "VulkanApp.hpp"
+
+#include <optional>
+
+// Measures intvlk::RadixSort in keys per second for key counts growing by a
+// factor of four, falling back to RadixSort::sortOnCpu on unsupported devices.
+class RadixSortBenchmark : public VulkanApp
+{
+public:
+    explicit RadixSortBenchmark(uint32_t minKeyCount = 1 << 20,
+                                uint32_t maxKeyCount = 1 << 30,
+                                bool withPayloads = false,
+                                uint32_t iterationCount = 5);
+
+    ~RadixSortBenchmark() override;
+
+    void run() override;
+
+private:
+    static uint32_t findMaxKeyCount(const vk::raii::PhysicalDevice &physicalDevice,
+                                    uint32_t maxKeyCount,
+                                    bool withPayloads);
+    intvlk::vma_utils::BufferData makeStorageBuffer(vk::DeviceSize size) const;
+    double sortOnGpu(const std::vector<uint32_t> &keys);
+    double sortOnCpu(const std::vector<uint32_t> &keys) const;
+
+    const std::string appName{"Radix Sort Benchmark"};
+
+    uint32_t minKeyCount;
+    bool withPayloads;
+    uint32_t iterationCount;
+    vk::raii::Context context{};
+    vk::raii::Instance instance;
+#if !defined(NDEBUG)
+    vk::raii::DebugUtilsMessengerEXT debugUtilsMessenger;
+#endif
+    vk::raii::PhysicalDevice physicalDevice;
+    bool gpuSupported;
+    uint32_t maxKeyCount;
+    uint32_t computeQueueFamilyIndex;
+    vk::raii::Device device;
+    intvlk::TimelineQueue computeQueue;
+    intvlk::PipelineCache pipelineCache;
+    std::shared_ptr<VmaAllocator_T> allocator;
+    vk::raii::CommandPool commandPool;
+    vk::raii::CommandBuffer commandBuffer;
+    intvlk::vma_utils::UploadContext uploadContext;
+    intvlk::glslang_utils::GlslangContext glslContext{};
+    // Unsorted input, copied over the working buffers before every iteration.
+    intvlk::vma_utils::BufferData sourceBufferData;
+    intvlk::vma_utils::BufferData keyBufferData;
+    intvlk::vma_utils::BufferData payloadBufferData;
+    std::optional<intvlk::RadixSort> radixSort{};
+};
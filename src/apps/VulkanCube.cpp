@@ -15,10 +15,14 @@
 
 #include "VulkanCube.hpp"
 
+#include <numbers>
+#include <random>
 #include <thread>
 
-VulkanCube::VulkanCube(uint32_t width, uint32_t height)
-    : windowData{appName, vk::Extent2D{width, height}},
+VulkanCube::VulkanCube(const VulkanCubeOptions &options)
+    : options{options.validate()},
+
+      windowData{appName, vk::Extent2D{options.width, options.height}},
 
       instance{intvlk::makeInstance(context,
                                     appName,
@@ -38,9 +42,20 @@ VulkanCube::VulkanCube(uint32_t width, uint32_t height)
 
       graphicsAndPresentQueueFamilyIndices{intvlk::findGraphicsAndPresentQueueFamilyIndices(physicalDevice, surface)},
 
+      transferQueueFamilyIndex{intvlk::findTransferQueueFamilyIndex(physicalDevice, graphicsAndPresentQueueFamilyIndices.first)},
+
+      queueRequests{makeQueueRequests()},
+
+      queueIndices{intvlk::getQueueIndices(physicalDevice, queueRequests)},
+
+      useMeshShaders{options.cullOnGpu && options.useMeshShaders && intvlk::isMeshShaderSupported(physicalDevice)},
+
       device{intvlk::makeDevice(physicalDevice,
-                                intvlk::getDeviceExtensions(),
-                                graphicsAndPresentQueueFamilyIndices.first)},
+                                makeDeviceExtensions(),
+                                queueRequests,
+                                options.cullOnGpu && !useMeshShaders)},
+
+      pipelineCache{physicalDevice, device, "vulkan_cube.pipeline_cache"},
 
       allocator{intvlk::vma_utils::makeAllocator(VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT,
                                                  physicalDevice,
@@ -50,43 +65,105 @@ VulkanCube::VulkanCube(uint32_t width, uint32_t height)
 
       perFrameData{intvlk::PerFrameData::make(queuedFramesCount, device, graphicsAndPresentQueueFamilyIndices.first)},
 
-      graphicsQueue{device, graphicsAndPresentQueueFamilyIndices.first, 0},
+      graphicsQueue{device, graphicsAndPresentQueueFamilyIndices.first, queueIndices[0]},
 
-      presentQueue{device, graphicsAndPresentQueueFamilyIndices.second, 0},
+      presentQueue{device,
+                   graphicsAndPresentQueueFamilyIndices.second,
+                   queueIndices.size() < 3 ? queueIndices[0] : queueIndices[2]},
 
-      swapchainData{makeSwapchain(true)},
+      transferQueue{device, transferQueueFamilyIndex, queueIndices[1]},
 
-      drawImage{device,
-                allocator,
-                drawImageFormat,
-                drawImageExtent,
-                vk::ImageTiling::eOptimal,
-                vk::ImageUsageFlagBits::eTransferSrc |
-                    vk::ImageUsageFlagBits::eTransferDst |
-                    vk::ImageUsageFlagBits::eStorage |
-                    vk::ImageUsageFlagBits::eColorAttachment,
-                vk::ImageLayout::eUndefined,
-                vk::MemoryPropertyFlagBits::eDeviceLocal,
-                VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT,
-                vk::ImageAspectFlagBits::eColor},
-
-      renderMatrix{intvlk::glm_utils::createModelViewProjectionClipMatrix(drawImageExtent)},
-
-      depthAttachmentData{device, allocator, vk::Format::eD32Sfloat, drawImage.extent},
+      swapchainData{makeSwapchain(true)},
 
-      meshData{device, allocator, intvlk::glm_utils::coloredCubeData.size() * sizeof(intvlk::glm_utils::Vertex)}
+      mesh{makeMesh(options)},
+
+      lodChain{std::move(intvlk::glm_utils::LodChain::makeInParallel(
+          threadPool,
+          std::span<const intvlk::glm_utils::MeshAsset>{&mesh, 1})[0])},
+
+      clusterCount{checkClusterCount()},
+
+      meshData{device,
+               allocator,
+               lodChain.indices.size() * sizeof(uint32_t),
+               mesh.vertices.size_bytes(),
+               static_cast<vk::DeviceSize>(options.cubeCount) * sizeof(glm::mat4)},
+
+      meshletData{device,
+                  allocator,
+                  lodChain.meshlets.meshlets.size() * sizeof(intvlk::glm_utils::Meshlet),
+                  lodChain.meshlets.vertexIndices.size() * sizeof(uint32_t),
+                  lodChain.meshlets.triangles.size() * sizeof(uint32_t),
+                  lodChain.lods.size() * sizeof(intvlk::glm_utils::MeshLod)},
+
+      drawCommandBufferData{device,
+                            allocator,
+                            (useMeshShaders ? 1 : getClusterCount()) * sizeof(vk::DrawIndexedIndirectCommand),
+                            vk::BufferUsageFlagBits::eIndirectBuffer |
+                                vk::BufferUsageFlagBits::eStorageBuffer |
+                                vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                            VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                            {},
+                            VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                                VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                                VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT},
+
+      drawCommandBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{drawCommandBufferData.buffer})},
+
+      drawCountBufferData{device,
+                          allocator,
+                          sizeof(uint32_t),
+                          vk::BufferUsageFlagBits::eIndirectBuffer |
+                              vk::BufferUsageFlagBits::eStorageBuffer |
+                              vk::BufferUsageFlagBits::eTransferSrc |
+                              vk::BufferUsageFlagBits::eTransferDst |
+                              vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                          VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                          {},
+                          VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                              VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT},
+
+      drawCountBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{drawCountBufferData.buffer})},
+
+      drawCountReadbackBufferData{makeDrawCountReadbackBufferData(queuedFramesCount, device, allocator)},
+
+      meshDrawDataBufferData{device,
+                             allocator,
+                             sizeof(VulkanCubeMeshDrawData),
+                             vk::BufferUsageFlagBits::eStorageBuffer |
+                                 vk::BufferUsageFlagBits::eTransferDst |
+                                 vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                             VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                             {},
+                             VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                                 VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT},
+
+      meshDrawDataBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{meshDrawDataBufferData.buffer})},
+
+      uploadContext{device, allocator, transferQueue, graphicsQueue}
 {
-    meshData.vertexBuffer.upload(
-        device,
-        vk::raii::CommandPool{
-            device,
-            vk::CommandPoolCreateInfo{vk::CommandPoolCreateFlags{}, graphicsAndPresentQueueFamilyIndices.first}},
-        graphicsQueue,
-        intvlk::glm_utils::coloredCubeData);
+    makeRenderTargets();
+
+    uploadContext.upload(meshData.indexBuffer, lodChain.indices);
+    uploadContext.upload(meshData.vertexBuffer, mesh.vertices);
+    uploadContext.upload(meshData.instanceBuffer, makeInstanceTransforms(options));
+    uploadContext.upload(meshletData.meshletBuffer, lodChain.meshlets.meshlets);
+    uploadContext.upload(meshletData.vertexIndexBuffer, lodChain.meshlets.vertexIndices);
+    uploadContext.upload(meshletData.triangleBuffer, lodChain.meshlets.triangles);
+    uploadContext.upload(meshletData.lodBuffer, lodChain.lods);
+    if (useMeshShaders)
+    {
+        setTaskWorkGroupCounts();
+        uploadMeshDrawData();
+    }
+    uploadContext.flush();
 
-    makeGraphicsPipeline();
+    makePipelines();
 }
 
+VulkanCube::VulkanCube(uint32_t width, uint32_t height)
+    : VulkanCube{VulkanCubeOptions{.width = width, .height = height}} {}
+
 VulkanCube::~VulkanCube()
 {
     device.waitIdle();
@@ -125,7 +202,12 @@ void VulkanCube::run()
             assert(0 < frameCount);
 
             SDL_SetWindowTitle(windowData.handle.get(),
-                               std::format("{}\tFPS = {}", windowData.getName(), frameCount).c_str());
+                               std::format("{}\tFPS = {}\tvisible meshlets = {}\tculled = {}",
+                                           windowData.getName(),
+                                           frameCount,
+                                           visibleClusterCount,
+                                           getClusterCount() - visibleClusterCount)
+                                   .c_str());
 
             accumulatedTime = std::chrono::high_resolution_clock::duration{};
             frameCount = 0;
@@ -133,11 +215,367 @@ void VulkanCube::run()
     }
 }
 
-void VulkanCube::drawGeometry(const vk::raii::CommandBuffer &commandBuffer) const
+uint32_t VulkanCube::getGridSide(uint32_t cubeCount)
+{
+    auto side{static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(cubeCount))))};
+    while (static_cast<uint64_t>(side) * side * side < cubeCount)
+    {
+        ++side;
+    }
+    while (1 < side && cubeCount <= static_cast<uint64_t>(side - 1) * (side - 1) * (side - 1))
+    {
+        --side;
+    }
+    return side;
+}
+
+// Every cube gets spacing^3 of the ball's volume, as it would in the grid.
+float VulkanCube::getRandomLayoutRadius(const VulkanCubeOptions &options)
+{
+    return options.spacing * std::cbrt(3.0f * static_cast<float>(options.cubeCount) / (4.0f * std::numbers::pi_v<float>));
+}
+
+float VulkanCube::getSceneRadius(const VulkanCubeOptions &options, float meshRadius)
+{
+    if (options.layout == CubeLayout::eGrid)
+    {
+        return std::sqrt(3.0f) * 0.5f * options.spacing * static_cast<float>(getGridSide(options.cubeCount) - 1) + meshRadius;
+    }
+    return getRandomLayoutRadius(options) + meshRadius;
+}
+
+std::vector<glm::mat4> VulkanCube::makeInstanceTransforms(const VulkanCubeOptions &options)
+{
+    std::vector<glm::mat4> transforms{};
+    transforms.reserve(options.cubeCount);
+
+    if (options.layout == CubeLayout::eGrid)
+    {
+        const uint32_t side{getGridSide(options.cubeCount)};
+        const float offset{0.5f * options.spacing * static_cast<float>(side - 1)};
+        for (uint32_t i{0}; i < options.cubeCount; ++i)
+        {
+            const glm::vec3 cell{static_cast<float>(i % side),
+                                 static_cast<float>(i / side % side),
+                                 static_cast<float>(i / (side * side))};
+            transforms.push_back(glm::translate(glm::mat4{1.0f}, options.spacing * cell - offset));
+        }
+        return transforms;
+    }
+
+    std::mt19937 generator{options.seed};
+    std::uniform_real_distribution<float> coordinate{-1.0f, 1.0f};
+    std::uniform_real_distribution<float> angle{0.0f, 2.0f * std::numbers::pi_v<float>};
+    // Rejection sampling keeps the points uniform in the ball and the axes uniform in direction.
+    const auto makePointInBall{[&](float minLength)
+                               {
+                                   glm::vec3 point{};
+                                   do
+                                   {
+                                       point = glm::vec3{coordinate(generator), coordinate(generator), coordinate(generator)};
+                                   } while (1.0f < glm::dot(point, point) || glm::dot(point, point) < minLength * minLength);
+                                   return point;
+                               }};
+    const float radius{getRandomLayoutRadius(options)};
+    for (uint32_t i{0}; i < options.cubeCount; ++i)
+    {
+        const glm::vec3 position{radius * makePointInBall(0.0f)};
+        const glm::vec3 axis{glm::normalize(makePointInBall(0.1f))};
+        transforms.push_back(glm::rotate(glm::translate(glm::mat4{1.0f}, position), angle(generator), axis));
+    }
+    return transforms;
+}
+
+intvlk::glm_utils::MeshAsset VulkanCube::makeMesh(const VulkanCubeOptions &options)
+{
+    if (options.meshFilename.empty())
+    {
+        return intvlk::glm_utils::MeshAsset{intvlk::glm_utils::QuantizedMesh::make(intvlk::glm_utils::coloredCubeData)};
+    }
+    intvlk::glm_utils::MeshAsset mesh{intvlk::glm_utils::MeshAsset::load(options.meshFilename)};
+    if (mesh.indices.empty())
+    {
+        throw intvlk::Error{"Mesh has no triangles: " + options.meshFilename};
+    }
+    return mesh;
+}
+
+std::vector<intvlk::vma_utils::BufferData> VulkanCube::makeDrawCountReadbackBufferData(
+    uint32_t count,
+    const vk::raii::Device &device,
+    const std::shared_ptr<VmaAllocator_T> &allocator)
+{
+    std::vector<intvlk::vma_utils::BufferData> bufferData{};
+    bufferData.reserve(count);
+    for (uint32_t i{0}; i < count; ++i)
+    {
+        bufferData.emplace_back(device,
+                                allocator,
+                                sizeof(uint32_t),
+                                vk::BufferUsageFlagBits::eTransferDst,
+                                VMA_MEMORY_USAGE_AUTO,
+                                vk::MemoryPropertyFlags{},
+                                VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT);
+        // Read before the first frame that uses the buffer has copied its count.
+        *static_cast<uint32_t *>(bufferData.back().allocationInfo.pMappedData) = 0;
+    }
+    return bufferData;
+}
+
+void VulkanCube::memoryBarrier(const vk::raii::CommandBuffer &commandBuffer,
+                               vk::PipelineStageFlags2 srcStageMask,
+                               vk::AccessFlags2 srcAccessMask,
+                               vk::PipelineStageFlags2 dstStageMask,
+                               vk::AccessFlags2 dstAccessMask)
+{
+    vk::MemoryBarrier2 barrier{srcStageMask, srcAccessMask, dstStageMask, dstAccessMask};
+    commandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, barrier});
+}
+
+// First write to an acquired swapchain image. The transition starts at the stage the
+// image's acquire semaphore is waited on, so it is ordered after the acquire.
+void VulkanCube::acquireSwapchainImage(const vk::raii::CommandBuffer &commandBuffer,
+                                       vk::Image image,
+                                       vk::ImageLayout newLayout,
+                                       vk::PipelineStageFlags2 dstStageMask,
+                                       vk::AccessFlags2 dstAccessMask)
+{
+    vk::ImageMemoryBarrier2 barrier{vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+                                    vk::AccessFlags2{},
+                                    dstStageMask,
+                                    dstAccessMask,
+                                    vk::ImageLayout::eUndefined,
+                                    newLayout,
+                                    vk::QueueFamilyIgnored,
+                                    vk::QueueFamilyIgnored,
+                                    image,
+                                    vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}};
+    commandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, nullptr, nullptr, barrier});
+}
+
+// Meshlets of the full mesh. Coarser levels of detail have fewer, so culling an instance
+// takes as many invocations as there are of these.
+uint32_t VulkanCube::getMeshletCount() const
+{
+    return lodChain.lods.front().meshletCount;
+}
+
+// Every meshlet of every cube is culled on its own.
+uint64_t VulkanCube::getClusterCount() const
+{
+    return clusterCount;
+}
+
+// The culling shaders index the clusters with 32 bits, and vulkan_cube_cull.comp
+// dispatches a column of workgroups per group of cubes and a row per meshlet, whose
+// draws are then issued by a single drawIndexedIndirectCount.
+uint64_t VulkanCube::checkClusterCount() const
+{
+    const uint64_t count{static_cast<uint64_t>(options.cubeCount) * getMeshletCount()};
+    const auto &limits{physicalDevice.getProperties().limits};
+    if (std::numeric_limits<uint32_t>::max() < count ||
+        (options.cullOnGpu && !useMeshShaders &&
+         (limits.maxComputeWorkGroupCount[0] < (static_cast<uint64_t>(options.cubeCount) + cullWorkGroupSize - 1) / cullWorkGroupSize ||
+          limits.maxComputeWorkGroupCount[1] < getMeshletCount() ||
+          limits.maxDrawIndirectCount < count)))
+    {
+        throw intvlk::Error{std::format("Too many meshlets to cull: {} cubes of {} meshlets",
+                                        options.cubeCount,
+                                        getMeshletCount())};
+    }
+    return count;
+}
+
+vk::Extent2D VulkanCube::getRenderExtent() const
+{
+    return options.renderTarget == RenderTarget::eFixedImage ? drawImageExtent : swapchainData.extent;
+}
+
+// Format of the images the pipelines draw into.
+vk::Format VulkanCube::getColorFormat() const
+{
+    return options.renderTarget == RenderTarget::eSwapchainImage ? swapchainData.colorFormat : drawImageFormat;
+}
+
+// Pixels covered by one unit of model space error at unit distance from the camera, divided
+// by the tolerated error, from the vertical field of view the projection is made with, as
+// the pixels are square. The culling shaders pick the coarsest level whose error times this,
+// times the instance's scale, stays within the distance to the instance's bounding sphere.
+float VulkanCube::getLodScale() const
+{
+    const vk::Extent2D extent{getRenderExtent()};
+    const float pixelsPerRadian{static_cast<float>(extent.height) /
+                                (2.0f * std::tan(0.5f * intvlk::glm_utils::getFieldOfView(extent)))};
+    // Zero tolerance makes the scale infinite, which keeps every instance at the full mesh.
+    return pixelsPerRadian / options.lodPixelError;
+}
+
+// Stage that culls the meshlets and writes the draw count.
+vk::PipelineStageFlags2 VulkanCube::getCullStage() const
+{
+    return useMeshShaders ? vk::PipelineStageFlagBits2::eTaskShaderEXT : vk::PipelineStageFlagBits2::eComputeShader;
+}
+
+std::vector<std::string> VulkanCube::makeDeviceExtensions() const
+{
+    std::vector<std::string> extensions{intvlk::getDeviceExtensions()};
+    if (useMeshShaders)
+    {
+        extensions.emplace_back(vk::EXTMeshShaderExtensionName);
+    }
+    return extensions;
+}
+
+void VulkanCube::setTaskWorkGroupCounts()
+{
+    const auto properties{physicalDevice.getProperties2<vk::PhysicalDeviceProperties2,
+                                                        vk::PhysicalDeviceMeshShaderPropertiesEXT>()};
+    const auto &meshShaderProperties{properties.get<vk::PhysicalDeviceMeshShaderPropertiesEXT>()};
+    const uint64_t workGroupCount{(getClusterCount() + taskWorkGroupSize - 1) / taskWorkGroupSize};
+    taskWorkGroupCountX = static_cast<uint32_t>(std::min<uint64_t>(workGroupCount,
+                                                                   meshShaderProperties.maxTaskWorkGroupCount[0]));
+    taskWorkGroupCountY = static_cast<uint32_t>((workGroupCount + taskWorkGroupCountX - 1) / taskWorkGroupCountX);
+    if (meshShaderProperties.maxTaskWorkGroupCount[1] < taskWorkGroupCountY ||
+        meshShaderProperties.maxTaskWorkGroupTotalCount < static_cast<uint64_t>(taskWorkGroupCountX) * taskWorkGroupCountY)
+    {
+        throw intvlk::Error{std::format("Too many meshlets to draw with mesh shaders: {} cubes of {} meshlets",
+                                        options.cubeCount,
+                                        getMeshletCount())};
+    }
+}
+
+// The draw data holds the camera position, so it is uploaded again whenever the view changes.
+void VulkanCube::uploadMeshDrawData()
+{
+    const VulkanCubeMeshDrawData meshDrawData{meshData.vertexBufferAddress,
+                                              meshData.instanceBufferAddress,
+                                              meshletData.meshletBufferAddress,
+                                              meshletData.vertexIndexBufferAddress,
+                                              meshletData.triangleBufferAddress,
+                                              drawCountBufferAddress,
+                                              mesh.positionDecode,
+                                              cameraPosition,
+                                              options.cubeCount,
+                                              getMeshletCount(),
+                                              mesh.boundingRadius,
+                                              meshletData.lodBufferAddress};
+    uploadContext.upload(meshDrawDataBufferData, &meshDrawData, sizeof(meshDrawData));
+}
+
+// Makes the draw and depth images of the render extent, and the view that depends on it.
+// Called on construction and, when they follow the swapchain's extent, after remaking it.
+void VulkanCube::makeRenderTargets()
+{
+    const vk::Extent2D extent{getRenderExtent()};
+
+    // The previous images are destroyed before their successors are allocated.
+    drawImage.reset();
+    if (options.renderTarget != RenderTarget::eSwapchainImage)
+    {
+        drawImage.emplace(device,
+                          allocator,
+                          drawImageFormat,
+                          extent,
+                          vk::ImageTiling::eOptimal,
+                          vk::ImageUsageFlagBits::eTransferSrc |
+                              vk::ImageUsageFlagBits::eTransferDst |
+                              vk::ImageUsageFlagBits::eStorage |
+                              vk::ImageUsageFlagBits::eColorAttachment,
+                          vk::ImageLayout::eUndefined,
+                          vk::MemoryPropertyFlagBits::eDeviceLocal,
+                          VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT,
+                          vk::ImageAspectFlagBits::eColor);
+    }
+    depthAttachmentData.reset();
+    depthAttachmentData.emplace(device, allocator, depthFormat, extent);
+
+    const float sceneRadius{getSceneRadius(options, mesh.boundingRadius)};
+    renderMatrix = intvlk::glm_utils::createViewProjectionClipMatrix(extent, sceneRadius);
+    cameraPosition = glm::vec4{intvlk::glm_utils::getViewPosition(sceneRadius), getLodScale()};
+}
+
+void VulkanCube::resetDrawCount(const vk::raii::CommandBuffer &commandBuffer) const
+{
+    // The previous frame may still be culling, drawing from the commands and copying their count.
+    memoryBarrier(commandBuffer,
+                  vk::PipelineStageFlagBits2::eDrawIndirect | vk::PipelineStageFlagBits2::eCopy | getCullStage(),
+                  vk::AccessFlagBits2::eShaderStorageWrite,
+                  vk::PipelineStageFlagBits2::eClear | getCullStage(),
+                  vk::AccessFlagBits2::eTransferWrite | vk::AccessFlagBits2::eShaderStorageWrite);
+
+    commandBuffer.fillBuffer(drawCountBufferData.buffer, 0, sizeof(uint32_t), 0);
+
+    memoryBarrier(commandBuffer,
+                  vk::PipelineStageFlagBits2::eClear,
+                  vk::AccessFlagBits2::eTransferWrite,
+                  getCullStage(),
+                  vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite);
+}
+
+// Copies the draw count, made visible to transfers by the caller, to the frame's readback buffer.
+void VulkanCube::copyDrawCount(const vk::raii::CommandBuffer &commandBuffer) const
+{
+    commandBuffer.copyBuffer(drawCountBufferData.buffer,
+                             drawCountReadbackBufferData[frameIndex].buffer,
+                             vk::BufferCopy{0, 0, sizeof(uint32_t)});
+
+    memoryBarrier(commandBuffer,
+                  vk::PipelineStageFlagBits2::eCopy,
+                  vk::AccessFlagBits2::eTransferWrite,
+                  vk::PipelineStageFlagBits2::eHost,
+                  vk::AccessFlagBits2::eHostRead);
+}
+
+// Writes a draw command for every meshlet of a cube's level of detail that intersects the
+// view frustum and faces the camera, and copies their count to the frame's readback buffer.
+void VulkanCube::cullMeshlets(const vk::raii::CommandBuffer &commandBuffer) const
+{
+    resetDrawCount(commandBuffer);
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, cullPipeline);
+
+    VulkanCubeCullPushConstants pushConstants{renderMatrix,
+                                              meshData.instanceBufferAddress,
+                                              meshletData.meshletBufferAddress,
+                                              drawCommandBufferAddress,
+                                              drawCountBufferAddress,
+                                              cameraPosition,
+                                              options.cubeCount,
+                                              mesh.boundingRadius,
+                                              meshletData.lodBufferAddress};
+
+    commandBuffer.pushConstants<VulkanCubeCullPushConstants>(cullPipelineLayout,
+                                                             vk::ShaderStageFlagBits::eCompute,
+                                                             0,
+                                                             pushConstants);
+
+    commandBuffer.dispatch((options.cubeCount + cullWorkGroupSize - 1) / cullWorkGroupSize,
+                           getMeshletCount(),
+                           1);
+
+    memoryBarrier(commandBuffer,
+                  vk::PipelineStageFlagBits2::eComputeShader,
+                  vk::AccessFlagBits2::eShaderStorageWrite,
+                  vk::PipelineStageFlagBits2::eDrawIndirect | vk::PipelineStageFlagBits2::eCopy,
+                  vk::AccessFlagBits2::eIndirectCommandRead | vk::AccessFlagBits2::eTransferRead);
+
+    copyDrawCount(commandBuffer);
+}
+
+void VulkanCube::drawGeometry(const vk::raii::CommandBuffer &commandBuffer, vk::ImageView colorImageView) const
 {
-    vk::RenderingAttachmentInfo colorAttachment{drawImage.imageView, vk::ImageLayout::eColorAttachmentOptimal};
+    const vk::Extent2D extent{getRenderExtent()};
 
-    vk::RenderingAttachmentInfo depthAttachment{depthAttachmentData.imageView,
+    vk::RenderingAttachmentInfo colorAttachment{colorImageView,
+                                                vk::ImageLayout::eColorAttachmentOptimal,
+                                                vk::ResolveModeFlagBits::eNone,
+                                                nullptr,
+                                                vk::ImageLayout::eUndefined,
+                                                vk::AttachmentLoadOp::eClear,
+                                                vk::AttachmentStoreOp::eStore,
+                                                vk::ClearColorValue{std::array<float, 4>{0.0f, 0.0f, 0.0f, 1.0f}}};
+
+    vk::RenderingAttachmentInfo depthAttachment{depthAttachmentData->imageView,
                                                 vk::ImageLayout::eDepthStencilAttachmentOptimal,
                                                 vk::ResolveModeFlagBits::eNone,
                                                 nullptr,
@@ -147,7 +585,7 @@ void VulkanCube::drawGeometry(const vk::raii::CommandBuffer &commandBuffer) cons
                                                 vk::ClearDepthStencilValue{1.0f, 0}};
 
     vk::RenderingInfo renderingInfo{vk::RenderingFlags{},
-                                    vk::Rect2D{vk::Offset2D{0, 0}, drawImage.extent},
+                                    vk::Rect2D{vk::Offset2D{0, 0}, extent},
                                     1,
                                     0,
                                     colorAttachment,
@@ -155,34 +593,111 @@ void VulkanCube::drawGeometry(const vk::raii::CommandBuffer &commandBuffer) cons
 
     commandBuffer.beginRendering(renderingInfo);
 
+    vk::Viewport viewport{0.0f,
+                          0.0f,
+                          static_cast<float>(extent.width),
+                          static_cast<float>(extent.height),
+                          0.0f,
+                          1.0f};
+
+    vk::Rect2D scissor{vk::Offset2D{0, 0}, extent};
+
+    if (useMeshShaders)
+    {
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, meshPipeline);
+
+        VulkanCubeMeshPushConstants pushConstants{renderMatrix, meshDrawDataBufferAddress};
+
+        commandBuffer.pushConstants<VulkanCubeMeshPushConstants>(meshPipelineLayout,
+                                                                 vk::ShaderStageFlagBits::eTaskEXT |
+                                                                     vk::ShaderStageFlagBits::eMeshEXT,
+                                                                 0,
+                                                                 pushConstants);
+
+        commandBuffer.setViewport(0, viewport);
+
+        commandBuffer.setScissor(0, scissor);
+
+        commandBuffer.drawMeshTasksEXT(taskWorkGroupCountX, taskWorkGroupCountY, 1);
+
+        commandBuffer.endRendering();
+        return;
+    }
+
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
 
     intvlk::glm_utils::DrawPushConstants pushConstants{renderMatrix,
-                                                       meshData.vertexBufferAddress};
+                                                       meshData.vertexBufferAddress,
+                                                       meshData.instanceBufferAddress,
+                                                       mesh.positionDecode};
 
     commandBuffer.pushConstants(pipelineLayout,
                                 vk::ShaderStageFlagBits::eVertex,
                                 0,
                                 vk::ArrayProxy<const intvlk::glm_utils::DrawPushConstants>{pushConstants});
 
-    vk::Viewport viewport{0.0f,
-                          0.0f,
-                          static_cast<float>(drawImage.extent.width),
-                          static_cast<float>(drawImage.extent.height),
-                          0.0f,
-                          1.0f};
-
     commandBuffer.setViewport(0, viewport);
 
-    vk::Rect2D scissor{vk::Offset2D{0, 0}, drawImage.extent};
-
     commandBuffer.setScissor(0, scissor);
 
-    commandBuffer.draw(static_cast<uint32_t>(intvlk::glm_utils::coloredCubeData.size()), 1, 0, 0);
+    commandBuffer.bindIndexBuffer(meshData.indexBuffer.buffer, 0, vk::IndexType::eUint32);
+
+    const uint32_t indexCount{lodChain.lods.front().indexCount};
+    if (options.cullOnGpu)
+    {
+        // The meshlets keep the mesh's triangle order, so each is a range of the index buffer.
+        commandBuffer.drawIndexedIndirectCount(drawCommandBufferData.buffer,
+                                               0,
+                                               drawCountBufferData.buffer,
+                                               0,
+                                               static_cast<uint32_t>(getClusterCount()),
+                                               sizeof(vk::DrawIndexedIndirectCommand));
+    }
+    else
+    {
+        commandBuffer.drawIndexed(indexCount, options.cubeCount, 0, 0, 0);
+    }
 
     commandBuffer.endRendering();
 }
 
+// Copies the draw image into the swapchain image and leaves the latter ready to present.
+void VulkanCube::blitDrawImage(const vk::raii::CommandBuffer &commandBuffer, uint32_t backBufferIndex) const
+{
+    intvlk::setImageLayout(commandBuffer,
+                           drawImage->image,
+                           drawImage->format,
+                           vk::ImageLayout::eColorAttachmentOptimal,
+                           vk::ImageLayout::eTransferSrcOptimal);
+
+    acquireSwapchainImage(commandBuffer,
+                          swapchainData.images[backBufferIndex],
+                          vk::ImageLayout::eTransferDstOptimal,
+                          vk::PipelineStageFlagBits2::eTransfer,
+                          vk::AccessFlagBits2::eTransferWrite);
+
+    // Only the bars left around a draw image of another aspect ratio need clearing.
+    if (intvlk::getBlitExtent(drawImage->extent, swapchainData.extent) != swapchainData.extent)
+    {
+        commandBuffer.clearColorImage(swapchainData.images[backBufferIndex],
+                                      vk::ImageLayout::eTransferDstOptimal,
+                                      vk::ClearColorValue{std::array<float, 4>{0.0f, 0.0f, 0.0f, 1.0f}},
+                                      vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+    }
+
+    intvlk::blitImage(commandBuffer,
+                      drawImage->image,
+                      drawImage->extent,
+                      swapchainData.images[backBufferIndex],
+                      swapchainData.extent);
+
+    intvlk::setImageLayout(commandBuffer,
+                           swapchainData.images[backBufferIndex],
+                           swapchainData.colorFormat,
+                           vk::ImageLayout::eTransferDstOptimal,
+                           vk::ImageLayout::ePresentSrcKHR);
+}
+
 void VulkanCube::draw()
 {
     while (vk::Result::eTimeout == device.waitForFences(*perFrameData[frameIndex].fence,
@@ -190,6 +705,17 @@ void VulkanCube::draw()
                                                         std::numeric_limits<uint64_t>::max()))
         ;
 
+    if (options.cullOnGpu)
+    {
+        const auto &readbackBufferData{drawCountReadbackBufferData[frameIndex]};
+        vmaInvalidateAllocation(allocator.get(), readbackBufferData.allocation.get(), 0, sizeof(uint32_t));
+        visibleClusterCount = *static_cast<const uint32_t *>(readbackBufferData.allocationInfo.pMappedData);
+    }
+    else
+    {
+        visibleClusterCount = getClusterCount();
+    }
+
     vk::Result result{};
     uint32_t backBufferIndex{};
 
@@ -214,42 +740,60 @@ void VulkanCube::draw()
 
     commandBuffer.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
 
-    intvlk::setImageLayout(commandBuffer,
-                           drawImage.image,
-                           drawImage.format,
-                           vk::ImageLayout::eUndefined,
-                           vk::ImageLayout::eColorAttachmentOptimal);
+    if (useMeshShaders)
+    {
+        resetDrawCount(commandBuffer);
+    }
+    else if (options.cullOnGpu)
+    {
+        cullMeshlets(commandBuffer);
+    }
 
-    drawGeometry(commandBuffer);
+    // Without a draw image the cubes are drawn straight into the swapchain image.
+    const vk::Image colorImage{drawImage ? *drawImage->image : swapchainData.images[backBufferIndex]};
 
-    intvlk::setImageLayout(commandBuffer,
-                           drawImage.image,
-                           drawImage.format,
-                           vk::ImageLayout::eColorAttachmentOptimal,
-                           vk::ImageLayout::eTransferSrcOptimal);
+    if (drawImage)
+    {
+        intvlk::setImageLayout(commandBuffer,
+                               colorImage,
+                               getColorFormat(),
+                               vk::ImageLayout::eUndefined,
+                               vk::ImageLayout::eColorAttachmentOptimal);
+    }
+    else
+    {
+        acquireSwapchainImage(commandBuffer,
+                              colorImage,
+                              vk::ImageLayout::eColorAttachmentOptimal,
+                              vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+                              vk::AccessFlagBits2::eColorAttachmentWrite);
+    }
 
-    intvlk::setImageLayout(commandBuffer,
-                           swapchainData.images[backBufferIndex],
-                           swapchainData.colorFormat,
-                           vk::ImageLayout::eUndefined,
-                           vk::ImageLayout::eTransferDstOptimal);
+    drawGeometry(commandBuffer, drawImage ? *drawImage->imageView : *swapchainData.imageViews[backBufferIndex]);
 
-    commandBuffer.clearColorImage(swapchainData.images[backBufferIndex],
-                                  vk::ImageLayout::eTransferDstOptimal,
-                                  vk::ClearColorValue{std::array<float, 4>{0.0f, 0.0f, 0.0f, 1.0f}},
-                                  vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+    if (useMeshShaders)
+    {
+        memoryBarrier(commandBuffer,
+                      vk::PipelineStageFlagBits2::eTaskShaderEXT,
+                      vk::AccessFlagBits2::eShaderStorageWrite,
+                      vk::PipelineStageFlagBits2::eCopy,
+                      vk::AccessFlagBits2::eTransferRead);
 
-    intvlk::blitImage(commandBuffer,
-                      drawImage.image,
-                      drawImage.extent,
-                      swapchainData.images[backBufferIndex],
-                      swapchainData.extent);
+        copyDrawCount(commandBuffer);
+    }
 
-    intvlk::setImageLayout(commandBuffer,
-                           swapchainData.images[backBufferIndex],
-                           swapchainData.colorFormat,
-                           vk::ImageLayout::eTransferDstOptimal,
-                           vk::ImageLayout::ePresentSrcKHR);
+    if (drawImage)
+    {
+        blitDrawImage(commandBuffer, backBufferIndex);
+    }
+    else
+    {
+        intvlk::setImageLayout(commandBuffer,
+                               colorImage,
+                               swapchainData.colorFormat,
+                               vk::ImageLayout::eColorAttachmentOptimal,
+                               vk::ImageLayout::ePresentSrcKHR);
+    }
 
     commandBuffer.end();
 
@@ -265,7 +809,7 @@ void VulkanCube::draw()
 
     vk::SubmitInfo2 submitInfo{vk::SubmitFlags{}, waitSemaphoreInfo, commandBufferSubmitInfo, signalSemaphoreInfo};
 
-    graphicsQueue.submit2(submitInfo, perFrameData[frameIndex].fence);
+    graphicsQueue.getQueue().submit2(submitInfo, perFrameData[frameIndex].fence);
 
     vk::PresentInfoKHR presentInfo{*perFrameData[frameIndex].renderCompleteSemaphore,
                                    *swapchainData.swapchain,
@@ -288,10 +832,8 @@ void VulkanCube::draw()
     assert(result == vk::Result::eSuccess);
 }
 
-void VulkanCube::makeGraphicsPipeline()
+void VulkanCube::makePipelines()
 {
-    intvlk::glslang_utils::GlslangContext glslContext{};
-
     vk::PushConstantRange pushConstantRange{vk::ShaderStageFlagBits::eVertex,
                                             0,
                                             sizeof(intvlk::glm_utils::DrawPushConstants)};
@@ -299,29 +841,103 @@ void VulkanCube::makeGraphicsPipeline()
         device,
         vk::PipelineLayoutCreateInfo{vk::PipelineLayoutCreateFlags{}, nullptr, pushConstantRange}};
 
-    vk::raii::ShaderModule vertexShaderModule{glslContext.makeShaderModule(
-        device,
-        vk::ShaderStageFlagBits::eVertex,
-        intvlk::readFile("src/shaders/vulkan_cube.vert"))};
-    vk::raii::ShaderModule fragmentShaderModule{glslContext.makeShaderModule(
+    vk::PushConstantRange cullPushConstantRange{vk::ShaderStageFlagBits::eCompute,
+                                                0,
+                                                sizeof(VulkanCubeCullPushConstants)};
+    cullPipelineLayout = vk::raii::PipelineLayout{
         device,
-        vk::ShaderStageFlagBits::eFragment,
-        intvlk::readFile("src/shaders/vulkan_cube.frag"))};
-
-    vk::raii::PipelineCache pipelineCache{device, vk::PipelineCacheCreateInfo{}};
-    pipeline = intvlk::makeGraphicsPipeline(device,
-                                            pipelineCache,
-                                            vertexShaderModule,
-                                            nullptr,
-                                            fragmentShaderModule,
-                                            nullptr,
-                                            0,
-                                            {},
-                                            vk::FrontFace::eClockwise,
-                                            true,
-                                            pipelineLayout,
-                                            drawImage.format,
-                                            depthAttachmentData.format);
+        vk::PipelineLayoutCreateInfo{vk::PipelineLayoutCreateFlags{}, nullptr, cullPushConstantRange}};
+
+    std::vector<intvlk::glslang_utils::ShaderFile> shaderFiles{
+        {vk::ShaderStageFlagBits::eVertex, "src/shaders/vulkan_cube.vert"},
+        {vk::ShaderStageFlagBits::eFragment, "src/shaders/vulkan_cube.frag"},
+        {vk::ShaderStageFlagBits::eCompute, "src/shaders/vulkan_cube_cull.comp"}};
+    // Task and mesh shaders are only valid on devices with the feature enabled.
+    if (useMeshShaders)
+    {
+        vk::PushConstantRange meshPushConstantRange{vk::ShaderStageFlagBits::eTaskEXT | vk::ShaderStageFlagBits::eMeshEXT,
+                                                    0,
+                                                    sizeof(VulkanCubeMeshPushConstants)};
+        meshPipelineLayout = vk::raii::PipelineLayout{
+            device,
+            vk::PipelineLayoutCreateInfo{vk::PipelineLayoutCreateFlags{}, nullptr, meshPushConstantRange}};
+
+        shaderFiles.push_back({vk::ShaderStageFlagBits::eTaskEXT, "src/shaders/vulkan_cube.task"});
+        shaderFiles.push_back({vk::ShaderStageFlagBits::eMeshEXT, "src/shaders/vulkan_cube.mesh"});
+    }
+    const std::vector<vk::raii::ShaderModule> shaderModules{
+        glslContext.makeShaderModulesFromFiles(device, threadPool, shaderFiles)};
+    const auto &vertexShaderModule{shaderModules[0]};
+    const auto &fragmentShaderModule{shaderModules[1]};
+    const auto &cullShaderModule{shaderModules[2]};
+
+    // Both culling shaders step through the levels of detail of lodChain.
+    const auto lodCount{static_cast<uint32_t>(lodChain.lods.size())};
+    const vk::SpecializationMapEntry specializationMapEntry{0, 0, sizeof(uint32_t)};
+    const vk::SpecializationInfo specializationInfo{1, &specializationMapEntry, sizeof(uint32_t), &lodCount};
+
+    std::vector<std::function<vk::raii::Pipeline()>> pipelineFactories{
+        [&]
+        { return intvlk::makeGraphicsPipeline(device,
+                                              pipelineCache.get(),
+                                              vertexShaderModule,
+                                              nullptr,
+                                              fragmentShaderModule,
+                                              nullptr,
+                                              0,
+                                              {},
+                                              vk::FrontFace::eClockwise,
+                                              true,
+                                              pipelineLayout,
+                                              getColorFormat(),
+                                              depthFormat); },
+        [&]
+        {
+            vk::ComputePipelineCreateInfo computePipelineCreateInfo{
+                vk::PipelineCreateFlags{},
+                vk::PipelineShaderStageCreateInfo{vk::PipelineShaderStageCreateFlags{},
+                                                  vk::ShaderStageFlagBits::eCompute,
+                                                  cullShaderModule,
+                                                  "main",
+                                                  &specializationInfo},
+                cullPipelineLayout};
+            return vk::raii::Pipeline{device, pipelineCache.get(), computePipelineCreateInfo};
+        }};
+    if (useMeshShaders)
+    {
+        pipelineFactories.push_back([&]
+                                    { return intvlk::makeMeshPipeline(device,
+                                                                      pipelineCache.get(),
+                                                                      shaderModules[3],
+                                                                      &specializationInfo,
+                                                                      shaderModules[4],
+                                                                      fragmentShaderModule,
+                                                                      vk::FrontFace::eClockwise,
+                                                                      true,
+                                                                      meshPipelineLayout,
+                                                                      getColorFormat(),
+                                                                      depthFormat); });
+    }
+
+    std::vector<vk::raii::Pipeline> pipelines{intvlk::makePipelinesInParallel(threadPool, pipelineFactories)};
+    pipeline = std::move(pipelines[0]);
+    cullPipeline = std::move(pipelines[1]);
+    if (useMeshShaders)
+    {
+        meshPipeline = std::move(pipelines[2]);
+    }
+}
+
+std::vector<intvlk::QueueRequest> VulkanCube::makeQueueRequests() const
+{
+    std::vector<intvlk::QueueRequest> requests{{graphicsAndPresentQueueFamilyIndices.first, graphicsQueuePriority},
+                                               {transferQueueFamilyIndex, transferQueuePriority}};
+    // Presenting from the graphics queue needs no queue of its own.
+    if (graphicsAndPresentQueueFamilyIndices.second != graphicsAndPresentQueueFamilyIndices.first)
+    {
+        requests.push_back({graphicsAndPresentQueueFamilyIndices.second, graphicsQueuePriority});
+    }
+    return requests;
 }
 
 intvlk::SwapchainData VulkanCube::makeSwapchain(bool isNew)
@@ -340,6 +956,7 @@ intvlk::SwapchainData VulkanCube::makeSwapchain(bool isNew)
 
 void VulkanCube::remakeSwapchain()
 {
+    const vk::Format colorFormat{getColorFormat()};
     try
     {
         swapchainData = makeSwapchain(false);
@@ -347,5 +964,22 @@ void VulkanCube::remakeSwapchain()
     catch (const intvlk::SwapchainZeroDimensionError &)
     {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        return;
+    }
+
+    // makeSwapchain waited for the device, so nothing uses the previous images any more.
+    if (options.renderTarget != RenderTarget::eFixedImage)
+    {
+        makeRenderTargets();
+        if (useMeshShaders)
+        {
+            uploadMeshDrawData();
+            uploadContext.flush();
+        }
+    }
+    // Pipelines are made for the format of the images they draw into.
+    if (getColorFormat() != colorFormat)
+    {
+        makePipelines();
     }
 }
@@ -18,10 +18,58 @@
 #include "include.hpp"
 
 #include "VulkanApp.hpp"
+#include "VulkanCubeOptions.hpp"
+
+#include <optional>
+
+class VulkanCubeCullPushConstants
+{
+public:
+    glm::mat4 renderMatrix;
+    vk::DeviceAddress instances;
+    vk::DeviceAddress meshlets;
+    vk::DeviceAddress drawCommands;
+    vk::DeviceAddress drawCount;
+    // Camera position in world space in xyz and the level of detail scale in w, see
+    // VulkanCube::getLodScale.
+    glm::vec4 cameraPosition;
+    uint32_t instanceCount;
+    // Radius of the mesh's bounding sphere around its origin in model space.
+    float boundingRadius;
+    vk::DeviceAddress lods;
+};
+
+// What vulkan_cube.task and vulkan_cube.mesh read besides the render matrix, which would
+// not fit in push constants along with it.
+class VulkanCubeMeshDrawData
+{
+public:
+    vk::DeviceAddress vertices;
+    vk::DeviceAddress instances;
+    vk::DeviceAddress meshlets;
+    vk::DeviceAddress meshletVertices;
+    vk::DeviceAddress meshletTriangles;
+    vk::DeviceAddress drawCount;
+    glm::vec4 positionDecode;
+    glm::vec4 cameraPosition;
+    uint32_t instanceCount;
+    uint32_t meshletCount;
+    float boundingRadius;
+    vk::DeviceAddress lods;
+};
+
+class VulkanCubeMeshPushConstants
+{
+public:
+    glm::mat4 renderMatrix;
+    vk::DeviceAddress drawData;
+};
 
 class VulkanCube final : public VulkanApp
 {
 public:
+    explicit VulkanCube(const VulkanCubeOptions &options);
+
     VulkanCube(uint32_t width, uint32_t height);
 
     ~VulkanCube() override;
@@ -29,17 +77,66 @@ public:
     void run() override;
 
 private:
-    void drawGeometry(const vk::raii::CommandBuffer &commandBuffer) const;
+    static uint32_t getGridSide(uint32_t cubeCount);
+    static float getRandomLayoutRadius(const VulkanCubeOptions &options);
+    static float getSceneRadius(const VulkanCubeOptions &options, float meshRadius);
+    static std::vector<glm::mat4> makeInstanceTransforms(const VulkanCubeOptions &options);
+    static intvlk::glm_utils::MeshAsset makeMesh(const VulkanCubeOptions &options);
+    static std::vector<intvlk::vma_utils::BufferData> makeDrawCountReadbackBufferData(
+        uint32_t count,
+        const vk::raii::Device &device,
+        const std::shared_ptr<VmaAllocator_T> &allocator);
+
+    static void memoryBarrier(const vk::raii::CommandBuffer &commandBuffer,
+                              vk::PipelineStageFlags2 srcStageMask,
+                              vk::AccessFlags2 srcAccessMask,
+                              vk::PipelineStageFlags2 dstStageMask,
+                              vk::AccessFlags2 dstAccessMask);
+    static void acquireSwapchainImage(const vk::raii::CommandBuffer &commandBuffer,
+                                      vk::Image image,
+                                      vk::ImageLayout newLayout,
+                                      vk::PipelineStageFlags2 dstStageMask,
+                                      vk::AccessFlags2 dstAccessMask);
+
+    uint32_t getMeshletCount() const;
+    uint64_t getClusterCount() const;
+    uint64_t checkClusterCount() const;
+    vk::Extent2D getRenderExtent() const;
+    vk::Format getColorFormat() const;
+    float getLodScale() const;
+    vk::PipelineStageFlags2 getCullStage() const;
+    std::vector<std::string> makeDeviceExtensions() const;
+    void setTaskWorkGroupCounts();
+    void uploadMeshDrawData();
+    void makeRenderTargets();
+
+    void resetDrawCount(const vk::raii::CommandBuffer &commandBuffer) const;
+    void copyDrawCount(const vk::raii::CommandBuffer &commandBuffer) const;
+    void cullMeshlets(const vk::raii::CommandBuffer &commandBuffer) const;
+
+    void drawGeometry(const vk::raii::CommandBuffer &commandBuffer, vk::ImageView colorImageView) const;
+    void blitDrawImage(const vk::raii::CommandBuffer &commandBuffer, uint32_t backBufferIndex) const;
 
     void draw();
-    void makeGraphicsPipeline();
+    std::vector<intvlk::QueueRequest> makeQueueRequests() const;
+    void makePipelines();
     intvlk::SwapchainData makeSwapchain(bool isNew);
     void remakeSwapchain();
 
     const std::string appName{"Vulkan Cube"};
     const vk::Format drawImageFormat{vk::Format::eR16G16B16A16Sfloat};
+    // Extent of the draw image with RenderTarget::eFixedImage.
     const vk::Extent2D drawImageExtent{1080, 1080};
+    const vk::Format depthFormat{vk::Format::eD32Sfloat};
     const uint32_t queuedFramesCount{2};
+    const float graphicsQueuePriority{1.0f};
+    const float transferQueuePriority{0.5f};
+    // Matches the local size of vulkan_cube_cull.comp.
+    const uint32_t cullWorkGroupSize{64};
+    // Matches the local size of vulkan_cube.task.
+    const uint32_t taskWorkGroupSize{32};
+
+    VulkanCubeOptions options;
 
     uint32_t frameIndex{};
     size_t frameCount{};
@@ -54,16 +151,63 @@ private:
     vk::raii::PhysicalDevice physicalDevice;
     vk::raii::SurfaceKHR surface;
     std::pair<uint32_t, uint32_t> graphicsAndPresentQueueFamilyIndices;
+    uint32_t transferQueueFamilyIndex;
+    // Graphics, transfer and, when it is another family, present.
+    std::vector<intvlk::QueueRequest> queueRequests;
+    std::vector<uint32_t> queueIndices;
+    // Draws with vulkan_cube.task and vulkan_cube.mesh where the device supports them,
+    // which cull the meshlets without a separate pass or indirect draws.
+    bool useMeshShaders;
     vk::raii::Device device;
+    intvlk::PipelineCache pipelineCache;
     std::shared_ptr<VmaAllocator_T> allocator;
     std::vector<intvlk::PerFrameData> perFrameData;
-    vk::raii::Queue graphicsQueue;
+    intvlk::TimelineQueue graphicsQueue;
     vk::raii::Queue presentQueue;
+    // Transfer queue of a dedicated family where the device has one, which copies the
+    // uploads of uploadContext into device-local memory and releases them to the graphics
+    // family. Culling is recorded with the draws on the graphics queue.
+    intvlk::TimelineQueue transferQueue;
     intvlk::SwapchainData swapchainData;
-    intvlk::vma_utils::ImageData drawImage;
-    glm::mat4 renderMatrix;
-    intvlk::vma_utils::DepthAttachmentData depthAttachmentData;
+    // Compiles shaders, simplifies meshes and creates pipelines concurrently.
+    intvlk::ThreadPool threadPool{};
+    // Loaded from options.meshFilename, or coloredCubeData with its duplicated vertices merged.
+    intvlk::glm_utils::MeshAsset mesh;
+    // Levels of detail of the mesh, whose indices fill the index buffer of meshData and
+    // whose meshlets fill meshletData.
+    intvlk::glm_utils::LodChain lodChain;
+    // Checked against the limits of the culling pass before any buffer is sized from it.
+    uint64_t clusterCount;
+    // Remade with the swapchain by makeRenderTargets unless options.renderTarget is
+    // RenderTarget::eFixedImage. There is no draw image with RenderTarget::eSwapchainImage.
+    std::optional<intvlk::vma_utils::ImageData> drawImage{};
+    std::optional<intvlk::vma_utils::DepthAttachmentData> depthAttachmentData{};
+    glm::mat4 renderMatrix{};
+    glm::vec4 cameraPosition{};
     intvlk::vma_utils::MeshData meshData;
+    intvlk::vma_utils::MeshletData meshletData;
+    // A vk::DrawIndexedIndirectCommand per visible meshlet of every cube and their count,
+    // both written by the culling pass and consumed by drawIndexedIndirectCount. Mesh
+    // shaders only count the visible meshlets, for the statistics.
+    intvlk::vma_utils::BufferData drawCommandBufferData;
+    vk::DeviceAddress drawCommandBufferAddress;
+    intvlk::vma_utils::BufferData drawCountBufferData;
+    vk::DeviceAddress drawCountBufferAddress;
+    // Copies of the draw count per queued frame, read once the frame's fence is signaled,
+    // so the statistics never stall the GPU.
+    std::vector<intvlk::vma_utils::BufferData> drawCountReadbackBufferData;
+    uint64_t visibleClusterCount{};
+    intvlk::vma_utils::BufferData meshDrawDataBufferData;
+    vk::DeviceAddress meshDrawDataBufferAddress;
+    // Task workgroups of drawMeshTasksEXT, spread over two dimensions when one is not enough.
+    uint32_t taskWorkGroupCountX{};
+    uint32_t taskWorkGroupCountY{};
+    intvlk::vma_utils::UploadContext uploadContext;
+    intvlk::glslang_utils::GlslangContext glslContext{};
     vk::raii::PipelineLayout pipelineLayout{VK_NULL_HANDLE};
     vk::raii::Pipeline pipeline{VK_NULL_HANDLE};
+    vk::raii::PipelineLayout cullPipelineLayout{VK_NULL_HANDLE};
+    vk::raii::Pipeline cullPipeline{VK_NULL_HANDLE};
+    vk::raii::PipelineLayout meshPipelineLayout{VK_NULL_HANDLE};
+    vk::raii::Pipeline meshPipeline{VK_NULL_HANDLE};
 };
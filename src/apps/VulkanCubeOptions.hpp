@@ -0,0 +1,74 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "include.hpp"
+
+enum class CubeLayout : uint32_t
+{
+    // Cubes on the points of a cubic grid.
+    eGrid,
+    // Randomly placed and rotated cubes filling a ball.
+    eRandom
+};
+
+enum class RenderTarget : uint32_t
+{
+    // A 1080x1080 image, scaled to fit into the window by a blit.
+    eFixedImage,
+    // An image of the window's size, which the blit only converts to the swapchain format.
+    eWindowSizedImage,
+    // The swapchain image itself, which needs neither a draw image nor a blit.
+    eSwapchainImage
+};
+
+class VulkanCubeOptions
+{
+public:
+    // Returns the options, so that VulkanCube checks them before deriving anything from them.
+    const VulkanCubeOptions &validate() const
+    {
+        if (cubeCount == 0)
+        {
+            throw intvlk::Error{"At least one cube must be drawn"};
+        }
+        return *this;
+    }
+
+    uint32_t width{900};
+    uint32_t height{600};
+    // Instances drawn with a single draw call; one is the cube of the original example.
+    uint32_t cubeCount{1};
+    CubeLayout layout{CubeLayout::eGrid};
+    // Distance between neighbouring cubes, which have an edge length of two.
+    float spacing{3.0f};
+    // Selects the random layout; the same seed always places the cubes the same way.
+    uint32_t seed{1};
+    // Culls the meshlets of the cubes against the view frustum and by their normal cones
+    // in a compute pass that writes the indirect draws; otherwise every cube is drawn.
+    bool cullOnGpu{true};
+    // Culls and draws the meshlets with task and mesh shaders instead, on devices that
+    // support VK_EXT_mesh_shader.
+    bool useMeshShaders{true};
+    // Screen-space error in pixels up to which the culling picks coarser levels of detail
+    // of the mesh for distant cubes; zero always draws the full mesh.
+    float lodPixelError{1.0f};
+    // Image the cubes are drawn into; the last two follow the window's size.
+    RenderTarget renderTarget{RenderTarget::eSwapchainImage};
+    // OBJ, glTF or GLB file drawn instead of the cube; it is converted once into mesh_cache.
+    std::string meshFilename{};
+};
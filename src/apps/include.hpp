@@ -20,6 +20,10 @@
 #include "../intvlk/glm_utils/DrawPushConstants.hpp"
 #include "../intvlk/glm_utils/geometries.hpp"
 #include "../intvlk/glm_utils/math.hpp"
+#include "../intvlk/glm_utils/MeshAsset.hpp"
+#include "../intvlk/glm_utils/Meshlets.hpp"
+#include "../intvlk/glm_utils/LodChain.hpp"
+#include "../intvlk/glm_utils/QuantizedMesh.hpp"
 #include "../intvlk/glm_utils/Vertex.hpp"
 
 #include "../intvlk/glslang_utils/GlslangContext.hpp"
@@ -29,8 +33,15 @@
 #include "../intvlk/vma_utils/DepthAttachmentData.hpp"
 #include "../intvlk/vma_utils/ImageData.hpp"
 #include "../intvlk/vma_utils/MeshData.hpp"
+#include "../intvlk/vma_utils/MeshletData.hpp"
+#include "../intvlk/vma_utils/UploadContext.hpp"
 
 #include "../intvlk/errors.hpp"
 #include "../intvlk/PerFrameData.hpp"
+#include "../intvlk/PipelineCache.hpp"
+#include "../intvlk/Profiler.hpp"
+#include "../intvlk/RadixSort.hpp"
 #include "../intvlk/SwapchainData.hpp"
+#include "../intvlk/ThreadPool.hpp"
+#include "../intvlk/TimelineQueue.hpp"
 #include "../intvlk/WindowData.hpp"
@@ -18,3 +18,7 @@
 #include "apps/VulkanApp.hpp"
 #include "apps/VulkanCube.hpp"
 #include "apps/HammingOneGenerator.hpp"
+#include "apps/HammingOneCpuGenerator.hpp"
+#include "apps/HammingOneSolver.hpp"
+#include "apps/HammingOneCpuSolver.hpp"
+#include "apps/RadixSortBenchmark.hpp"
@@ -0,0 +1,69 @@
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "EmbeddedShaders.hpp"
+
+#include <array>
+
+// Generated by the custom build step of src/shaders in InteractiveVulkan.vcxproj;
+// every shader compiled there needs an entry below as well.
+#if defined(INTVLK_EMBEDDED_SHADERS)
+#include "hamming_one_generator.comp.h"
+#include "hamming_one_solver.comp.h"
+#include "radix_sort.comp.h"
+#include "vulkan_cube.frag.h"
+#include "vulkan_cube.mesh.h"
+#include "vulkan_cube.task.h"
+#include "vulkan_cube.vert.h"
+#include "vulkan_cube_cull.comp.h"
+#endif
+
+namespace intvlk
+{
+    namespace
+    {
+        class EmbeddedShader
+        {
+        public:
+            std::string_view filename;
+            std::span<const uint32_t> code;
+        };
+    }
+
+    std::span<const uint32_t> findEmbeddedShader(std::string_view filename)
+    {
+#if defined(INTVLK_EMBEDDED_SHADERS)
+        static const std::array embeddedShaders{
+            EmbeddedShader{"src/shaders/hamming_one_generator.comp", hamming_one_generator_comp_spv},
+            EmbeddedShader{"src/shaders/hamming_one_solver.comp", hamming_one_solver_comp_spv},
+            EmbeddedShader{"src/shaders/radix_sort.comp", radix_sort_comp_spv},
+            EmbeddedShader{"src/shaders/vulkan_cube.frag", vulkan_cube_frag_spv},
+            EmbeddedShader{"src/shaders/vulkan_cube.mesh", vulkan_cube_mesh_spv},
+            EmbeddedShader{"src/shaders/vulkan_cube.task", vulkan_cube_task_spv},
+            EmbeddedShader{"src/shaders/vulkan_cube.vert", vulkan_cube_vert_spv},
+            EmbeddedShader{"src/shaders/vulkan_cube_cull.comp", vulkan_cube_cull_comp_spv}};
+        for (const auto &embeddedShader : embeddedShaders)
+        {
+            if (embeddedShader.filename == filename)
+            {
+                return embeddedShader.code;
+            }
+        }
+#else
+        static_cast<void>(filename);
+#endif
+        return {};
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "include.hpp"
+
+#include <span>
+#include <string_view>
+
+namespace intvlk
+{
+    // SPIR-V compiled from the file at build time, or nothing when shaders are not
+    // embedded or the file is not one of src/shaders. Defined in EmbeddedShaders.cpp,
+    // the only translation unit that includes the generated SPIR-V arrays.
+    std::span<const uint32_t> findEmbeddedShader(std::string_view filename);
+}
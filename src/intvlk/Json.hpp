@@ -0,0 +1,383 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include "errors.hpp"
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace intvlk
+{
+    // Just enough of JSON to read glTF documents, which are parsed once and then only
+    // looked up, so objects are kept as parallel key and value vectors.
+    class JsonValue
+    {
+    public:
+        enum class Type : uint32_t
+        {
+            eNull,
+            eBool,
+            eNumber,
+            eString,
+            eArray,
+            eObject
+        };
+
+        static JsonValue parse(std::string_view text)
+        {
+            Parser parser{text};
+            JsonValue value{parser.parseValue(0)};
+            parser.skipWhitespace();
+            if (parser.position != text.size())
+            {
+                parser.fail("unexpected trailing characters");
+            }
+            return value;
+        }
+
+        // Member of an object, or nullptr when the value is not an object or has no such key.
+        const JsonValue *find(std::string_view key) const
+        {
+            for (size_t i{0}; i < keys.size(); ++i)
+            {
+                if (keys[i] == key)
+                {
+                    return &elements[i];
+                }
+            }
+            return nullptr;
+        }
+
+        const JsonValue &operator[](std::string_view key) const
+        {
+            const JsonValue *value{find(key)};
+            if (value == nullptr)
+            {
+                throw Error{"Missing JSON member: " + std::string{key}};
+            }
+            return *value;
+        }
+
+        const JsonValue &operator[](size_t index) const
+        {
+            if (type != Type::eArray || elements.size() <= index)
+            {
+                throw Error{"JSON array index out of range: " + std::to_string(index)};
+            }
+            return elements[index];
+        }
+
+        size_t size() const
+        {
+            return elements.size();
+        }
+
+        double getNumber() const
+        {
+            if (type != Type::eNumber)
+            {
+                throw Error{"JSON value is not a number"};
+            }
+            return number;
+        }
+
+        uint32_t getUint() const
+        {
+            const double value{getNumber()};
+            if (value < 0.0 || 4294967295.0 < value || value != static_cast<double>(static_cast<uint32_t>(value)))
+            {
+                throw Error{"JSON value is not an unsigned integer"};
+            }
+            return static_cast<uint32_t>(value);
+        }
+
+        const std::string &getString() const
+        {
+            if (type != Type::eString)
+            {
+                throw Error{"JSON value is not a string"};
+            }
+            return string;
+        }
+
+        // Number of a member, or defaultValue when it is missing.
+        double getNumber(std::string_view key, double defaultValue) const
+        {
+            const JsonValue *value{find(key)};
+            return value ? value->getNumber() : defaultValue;
+        }
+
+        uint32_t getUint(std::string_view key, uint32_t defaultValue) const
+        {
+            const JsonValue *value{find(key)};
+            return value ? value->getUint() : defaultValue;
+        }
+
+        Type type{Type::eNull};
+        bool boolean{};
+        double number{};
+        std::string string{};
+        // Items of an array, or values of an object in the order of keys.
+        std::vector<JsonValue> elements{};
+        std::vector<std::string> keys{};
+
+    private:
+        class Parser
+        {
+        public:
+            // Deeper documents are rejected rather than allowed to exhaust the stack.
+            static constexpr uint32_t maxDepth{256};
+
+            [[noreturn]] void fail(std::string_view message) const
+            {
+                throw Error{"Invalid JSON at offset " + std::to_string(position) + ": " + std::string{message}};
+            }
+
+            void skipWhitespace()
+            {
+                while (position < text.size() &&
+                       (text[position] == ' ' || text[position] == '\t' || text[position] == '\n' || text[position] == '\r'))
+                {
+                    ++position;
+                }
+            }
+
+            void expect(char c)
+            {
+                skipWhitespace();
+                if (position == text.size() || text[position] != c)
+                {
+                    fail(std::string{"expected '"} + c + '\'');
+                }
+                ++position;
+            }
+
+            bool consume(std::string_view literal)
+            {
+                if (text.substr(position, literal.size()) == literal)
+                {
+                    position += literal.size();
+                    return true;
+                }
+                return false;
+            }
+
+            JsonValue parseValue(uint32_t depth)
+            {
+                if (maxDepth < depth)
+                {
+                    fail("nesting too deep");
+                }
+                skipWhitespace();
+                if (position == text.size())
+                {
+                    fail("unexpected end");
+                }
+                JsonValue value{};
+                const char c{text[position]};
+                if (c == '{')
+                {
+                    value.type = Type::eObject;
+                    ++position;
+                    skipWhitespace();
+                    if (position < text.size() && text[position] == '}')
+                    {
+                        ++position;
+                        return value;
+                    }
+                    do
+                    {
+                        skipWhitespace();
+                        value.keys.push_back(parseString());
+                        expect(':');
+                        value.elements.push_back(parseValue(depth + 1));
+                        skipWhitespace();
+                    } while (position < text.size() && text[position] == ',' && ++position);
+                    expect('}');
+                }
+                else if (c == '[')
+                {
+                    value.type = Type::eArray;
+                    ++position;
+                    skipWhitespace();
+                    if (position < text.size() && text[position] == ']')
+                    {
+                        ++position;
+                        return value;
+                    }
+                    do
+                    {
+                        value.elements.push_back(parseValue(depth + 1));
+                        skipWhitespace();
+                    } while (position < text.size() && text[position] == ',' && ++position);
+                    expect(']');
+                }
+                else if (c == '"')
+                {
+                    value.type = Type::eString;
+                    value.string = parseString();
+                }
+                else if (consume("true"))
+                {
+                    value.type = Type::eBool;
+                    value.boolean = true;
+                }
+                else if (consume("false"))
+                {
+                    value.type = Type::eBool;
+                }
+                else if (consume("null"))
+                {
+                }
+                else
+                {
+                    value.type = Type::eNumber;
+                    const char *first{text.data() + position};
+                    const auto [last, errorCode]{std::from_chars(first, text.data() + text.size(), value.number)};
+                    if (errorCode != std::errc{} || last == first)
+                    {
+                        fail("invalid value");
+                    }
+                    position += static_cast<size_t>(last - first);
+                }
+                return value;
+            }
+
+            std::string parseString()
+            {
+                if (position == text.size() || text[position] != '"')
+                {
+                    fail("expected a string");
+                }
+                ++position;
+                std::string result{};
+                while (true)
+                {
+                    if (position == text.size())
+                    {
+                        fail("unterminated string");
+                    }
+                    const char c{text[position++]};
+                    if (c == '"')
+                    {
+                        return result;
+                    }
+                    if (c != '\\')
+                    {
+                        result += c;
+                        continue;
+                    }
+                    if (position == text.size())
+                    {
+                        fail("unterminated string");
+                    }
+                    switch (const char escaped{text[position++]})
+                    {
+                    case 'b':
+                        result += '\b';
+                        break;
+                    case 'f':
+                        result += '\f';
+                        break;
+                    case 'n':
+                        result += '\n';
+                        break;
+                    case 'r':
+                        result += '\r';
+                        break;
+                    case 't':
+                        result += '\t';
+                        break;
+                    case 'u':
+                        appendUtf8(result, parseCodePoint());
+                        break;
+                    default:
+                        result += escaped;
+                        break;
+                    }
+                }
+            }
+
+        private:
+            static void appendUtf8(std::string &result, uint32_t codePoint)
+            {
+                if (codePoint < 0x80)
+                {
+                    result += static_cast<char>(codePoint);
+                }
+                else if (codePoint < 0x800)
+                {
+                    result += static_cast<char>(0xC0 | codePoint >> 6);
+                    result += static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+                else if (codePoint < 0x10000)
+                {
+                    result += static_cast<char>(0xE0 | codePoint >> 12);
+                    result += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+                    result += static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+                else
+                {
+                    result += static_cast<char>(0xF0 | codePoint >> 18);
+                    result += static_cast<char>(0x80 | (codePoint >> 12 & 0x3F));
+                    result += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+                    result += static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+            }
+
+            uint32_t parseHex4()
+            {
+                if (text.size() < position + 4)
+                {
+                    fail("truncated \\u escape");
+                }
+                uint32_t codeUnit{};
+                const auto [last, errorCode]{std::from_chars(text.data() + position, text.data() + position + 4, codeUnit, 16)};
+                if (errorCode != std::errc{} || last != text.data() + position + 4)
+                {
+                    fail("invalid \\u escape");
+                }
+                position += 4;
+                return codeUnit;
+            }
+
+            // Combines a surrogate pair into one code point.
+            uint32_t parseCodePoint()
+            {
+                const uint32_t high{parseHex4()};
+                if (0xD800 <= high && high < 0xDC00 && consume("\\u"))
+                {
+                    const uint32_t low{parseHex4()};
+                    if (0xDC00 <= low && low < 0xE000)
+                    {
+                        return 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    fail("invalid surrogate pair");
+                }
+                return high;
+            }
+
+        public:
+            std::string_view text;
+            size_t position{};
+        };
+    };
+}
@@ -0,0 +1,109 @@
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "MappedFile.hpp"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace intvlk
+{
+    MappedFile::MappedFile(const std::filesystem::path &filename)
+    {
+#if defined(_WIN32)
+        HANDLE file{CreateFileW(filename.c_str(),
+                                GENERIC_READ,
+                                FILE_SHARE_READ,
+                                nullptr,
+                                OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                nullptr)};
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throw Error{"Failed to open file: " + filename.string()};
+        }
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize))
+        {
+            CloseHandle(file);
+            throw Error{"Failed to get the size of file: " + filename.string()};
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+        if (0 < size)
+        {
+            HANDLE mapping{CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr)};
+            if (mapping != nullptr)
+            {
+                data = static_cast<const std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        const int file{open(filename.c_str(), O_RDONLY)};
+        if (file < 0)
+        {
+            throw Error{"Failed to open file: " + filename.string()};
+        }
+        struct stat fileStatus{};
+        if (fstat(file, &fileStatus) != 0)
+        {
+            close(file);
+            throw Error{"Failed to get the size of file: " + filename.string()};
+        }
+        size = static_cast<size_t>(fileStatus.st_size);
+        if (0 < size)
+        {
+            void *address{mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0)};
+            if (address != MAP_FAILED)
+            {
+                data = static_cast<const std::byte *>(address);
+            }
+        }
+        close(file);
+#endif
+        if (0 < size && data == nullptr)
+        {
+            throw Error{"Failed to map file: " + filename.string()};
+        }
+    }
+
+    void MappedFile::unmap()
+    {
+        if (data == nullptr)
+        {
+            return;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(data);
+#else
+        munmap(const_cast<std::byte *>(data), size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include "errors.hpp"
+
+#include <filesystem>
+#include <span>
+#include <utility>
+
+namespace intvlk
+{
+    // Read-only view of a whole file mapped into memory, so its pages are only read
+    // from disk when touched and never copied into a buffer of our own. The platform
+    // code lives in MappedFile.cpp, which keeps <windows.h> out of the headers.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+
+        // Throws an Error when the file cannot be opened or mapped.
+        explicit MappedFile(const std::filesystem::path &filename);
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        MappedFile(MappedFile &&other) noexcept
+            : data{std::exchange(other.data, nullptr)},
+
+              size{std::exchange(other.size, 0)}
+        {
+        }
+
+        MappedFile &operator=(MappedFile &&other) noexcept
+        {
+            if (this != &other)
+            {
+                unmap();
+                data = std::exchange(other.data, nullptr);
+                size = std::exchange(other.size, 0);
+            }
+            return *this;
+        }
+
+        ~MappedFile()
+        {
+            unmap();
+        }
+
+        std::span<const std::byte> getData() const
+        {
+            return {data, size};
+        }
+
+    private:
+        void unmap();
+
+        const std::byte *data{nullptr};
+        size_t size{};
+    };
+}
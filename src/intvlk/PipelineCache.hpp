@@ -0,0 +1,135 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "include.hpp"
+
+#include "ThreadPool.hpp"
+#include "utils.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+
+namespace intvlk
+{
+    // A pipeline cache loaded from a file and written back when it is destroyed. Data
+    // saved for another vendor, device or driver build, as told by its header, is
+    // dropped instead of being handed to the driver. The file is replaced by renaming
+    // a fully written temporary file over it, so a crash never leaves a truncated cache.
+    // The cache is created without the externally synchronized flag, so pipelines can
+    // be created with it from several threads at once.
+    class PipelineCache
+    {
+    public:
+        PipelineCache(const vk::raii::PhysicalDevice &physicalDevice,
+                      const vk::raii::Device &device,
+                      std::filesystem::path _filename)
+            : filename{std::move(_filename)},
+
+              pipelineCache{makePipelineCache(physicalDevice, device, filename)}
+        {
+        }
+
+        PipelineCache(const PipelineCache &) = delete;
+        PipelineCache &operator=(const PipelineCache &) = delete;
+
+        PipelineCache(PipelineCache &&) = delete;
+        PipelineCache &operator=(PipelineCache &&) = delete;
+
+        ~PipelineCache()
+        {
+            try
+            {
+                save();
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Failed to save the pipeline cache: " << e.what() << '\n';
+            }
+        }
+
+        static vk::raii::PipelineCache makePipelineCache(const vk::raii::PhysicalDevice &physicalDevice,
+                                                         const vk::raii::Device &device,
+                                                         const std::filesystem::path &filename)
+        {
+            std::vector<char> data{};
+            if (std::ifstream file{filename, std::ios::binary | std::ios::ate})
+            {
+                data.resize(static_cast<size_t>(file.tellg()));
+                file.seekg(0);
+                file.read(data.data(), static_cast<std::streamsize>(data.size()));
+                if (!file || !isCompatible(data, physicalDevice.getProperties()))
+                {
+                    data.clear();
+                }
+            }
+            return vk::raii::PipelineCache{
+                device,
+                vk::PipelineCacheCreateInfo{vk::PipelineCacheCreateFlags{}, data.size(), data.data()}};
+        }
+
+        static bool isCompatible(const std::vector<char> &data, const vk::PhysicalDeviceProperties &properties)
+        {
+            vk::PipelineCacheHeaderVersionOne header{};
+            if (data.size() < sizeof(header))
+            {
+                return false;
+            }
+            memcpy(&header, data.data(), sizeof(header));
+            return sizeof(header) <= header.headerSize &&
+                   header.headerSize <= data.size() &&
+                   header.headerVersion == vk::PipelineCacheHeaderVersion::eOne &&
+                   header.vendorID == properties.vendorID &&
+                   header.deviceID == properties.deviceID &&
+                   header.pipelineCacheUUID == properties.pipelineCacheUUID;
+        }
+
+        void save() const
+        {
+            const std::vector<uint8_t> data{pipelineCache.getData()};
+            if (!writeFile(filename, {std::as_bytes(std::span{data})}))
+            {
+                throw Error{"Failed to write " + filename.string()};
+            }
+        }
+
+        const vk::raii::PipelineCache &get() const
+        {
+            return pipelineCache;
+        }
+
+    private:
+        std::filesystem::path filename;
+        vk::raii::PipelineCache pipelineCache;
+    };
+
+    // Runs every factory on threadPool and returns the pipelines in the order of the factories.
+    inline std::vector<vk::raii::Pipeline> makePipelinesInParallel(
+        ThreadPool &threadPool,
+        const std::vector<std::function<vk::raii::Pipeline()>> &pipelineFactories)
+    {
+        std::vector<std::future<vk::raii::Pipeline>> futurePipelines{};
+        futurePipelines.reserve(pipelineFactories.size());
+        for (const auto &pipelineFactory : pipelineFactories)
+        {
+            futurePipelines.push_back(threadPool.submit(pipelineFactory));
+        }
+        return ThreadPool::waitAll(std::move(futurePipelines));
+    }
+}
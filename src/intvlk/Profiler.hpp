@@ -0,0 +1,277 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "include.hpp"
+
+#include "errors.hpp"
+
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <ostream>
+
+namespace intvlk
+{
+    // Accumulates per-stage durations from GPU timestamp queries around command
+    // buffer regions and from CPU wall-clock scopes, and reports them with the
+    // throughput of the bytes each stage moved.
+    class Profiler
+    {
+    public:
+        enum class Source : uint32_t
+        {
+            eGpu,
+            eCpu
+        };
+
+        class Stage
+        {
+        public:
+            std::string name{};
+            Source source{};
+            uint64_t count{};
+            double seconds{};
+            uint64_t byteCount{};
+        };
+
+        // Times the enclosing block on the CPU.
+        class CpuScope
+        {
+        public:
+            CpuScope(Profiler &_profiler, std::string_view stageName, uint64_t _byteCount = 0)
+                : profiler{_profiler},
+
+                  stage{profiler.findStage(stageName, Source::eCpu)},
+
+                  byteCount{_byteCount}
+            {
+            }
+
+            CpuScope(const CpuScope &) = delete;
+            CpuScope &operator=(const CpuScope &) = delete;
+
+            CpuScope(CpuScope &&) = delete;
+            CpuScope &operator=(CpuScope &&) = delete;
+
+            ~CpuScope()
+            {
+                const std::chrono::duration<double> elapsedTime{std::chrono::high_resolution_clock::now() - startTime};
+                profiler.addSample(stage, elapsedTime.count(), byteCount);
+            }
+
+        private:
+            Profiler &profiler;
+            uint32_t stage;
+            uint64_t byteCount;
+            std::chrono::high_resolution_clock::time_point startTime{std::chrono::high_resolution_clock::now()};
+        };
+
+        static constexpr uint32_t noRegion{0xFFFFFFFF};
+
+        // Only CPU scopes are recorded.
+        Profiler() = default;
+
+        // At most maxGpuRegionCount GPU regions may be recorded and not yet collected.
+        Profiler(const vk::raii::PhysicalDevice &physicalDevice,
+                 const vk::raii::Device &device,
+                 uint32_t queueFamilyIndex,
+                 uint32_t maxGpuRegionCount)
+            : timestampPeriod{physicalDevice.getProperties().limits.timestampPeriod},
+
+              timestampValidBits{physicalDevice.getQueueFamilyProperties()[queueFamilyIndex].timestampValidBits},
+
+              gpuRegions(timestampValidBits ? maxGpuRegionCount : 0)
+        {
+            if (!gpuRegions.empty())
+            {
+                queryPool = vk::raii::QueryPool{
+                    device,
+                    vk::QueryPoolCreateInfo{vk::QueryPoolCreateFlags{}, vk::QueryType::eTimestamp, 2 * maxGpuRegionCount}};
+                queryPool.reset(0, 2 * maxGpuRegionCount);
+            }
+        }
+
+        Profiler(const Profiler &) = delete;
+        Profiler &operator=(const Profiler &) = delete;
+
+        Profiler(Profiler &&) = delete;
+        Profiler &operator=(Profiler &&) = delete;
+
+        // Returns the region to pass to endGpuRegion, or noRegion when the queue has no timestamps.
+        uint32_t beginGpuRegion(const vk::raii::CommandBuffer &commandBuffer,
+                                std::string_view stageName,
+                                uint64_t byteCount = 0)
+        {
+            if (gpuRegions.empty())
+            {
+                return noRegion;
+            }
+            const uint32_t region{nextGpuRegion};
+            nextGpuRegion = (nextGpuRegion + 1) % static_cast<uint32_t>(gpuRegions.size());
+            if (gpuRegions[region].pending)
+            {
+                // Regions are reused in order, so this one was submitted before the current one.
+                collect(region, true);
+            }
+            gpuRegions[region] = GpuRegion{findStage(stageName, Source::eGpu), byteCount, true};
+            // Waiting for all earlier commands attributes only this region's work to it.
+            commandBuffer.writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, queryPool, 2 * region);
+            return region;
+        }
+
+        void endGpuRegion(const vk::raii::CommandBuffer &commandBuffer, uint32_t region) const
+        {
+            if (region != noRegion)
+            {
+                commandBuffer.writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, queryPool, 2 * region + 1);
+            }
+        }
+
+        // Adds the regions whose command buffers have finished executing.
+        void collect()
+        {
+            for (uint32_t region{0}; region < gpuRegions.size(); ++region)
+            {
+                if (gpuRegions[region].pending)
+                {
+                    collect(region, false);
+                }
+            }
+        }
+
+        const std::vector<Stage> &getStages() const
+        {
+            return stages;
+        }
+
+        void report(std::ostream &stream) const
+        {
+            stream << std::format("{:<16}{:>6}{:>8}{:>12}{:>12}{:>10}\n", "stage", "source", "calls", "total ms", "mean ms", "GB/s");
+            for (const auto &stage : stages)
+            {
+                stream << std::format("{:<16}{:>6}{:>8}{:>12.3f}{:>12.3f}{:>10}\n",
+                                      stage.name,
+                                      toString(stage.source),
+                                      stage.count,
+                                      stage.seconds * 1e3,
+                                      stage.count ? stage.seconds * 1e3 / static_cast<double>(stage.count) : 0.0,
+                                      stage.byteCount && 0 < stage.seconds
+                                          ? std::format("{:.2f}", getGigabytesPerSecond(stage))
+                                          : std::string{"-"});
+            }
+        }
+
+        void writeJson(const std::string &filename) const
+        {
+            std::ofstream file{filename};
+            if (!file)
+            {
+                throw Error{"Failed to open file: " + filename};
+            }
+            file << "{\n  \"stages\": [";
+            for (size_t i{0}; i < stages.size(); ++i)
+            {
+                const auto &stage{stages[i]};
+                file << std::format("{}\n    {{\"name\": \"{}\", \"source\": \"{}\", \"count\": {}, \"seconds\": {}, "
+                                    "\"bytes\": {}, \"gigabytesPerSecond\": {}}}",
+                                    i ? "," : "",
+                                    stage.name,
+                                    toString(stage.source),
+                                    stage.count,
+                                    stage.seconds,
+                                    stage.byteCount,
+                                    getGigabytesPerSecond(stage));
+            }
+            file << "\n  ]\n}\n";
+            if (!file)
+            {
+                throw Error{"Failed to write file: " + filename};
+            }
+        }
+
+    private:
+        class GpuRegion
+        {
+        public:
+            uint32_t stage{};
+            uint64_t byteCount{};
+            bool pending{};
+        };
+
+        static std::string_view toString(Source source)
+        {
+            return source == Source::eGpu ? "gpu" : "cpu";
+        }
+
+        static double getGigabytesPerSecond(const Stage &stage)
+        {
+            return 0 < stage.seconds ? static_cast<double>(stage.byteCount) / stage.seconds * 1e-9 : 0.0;
+        }
+
+        // Stage names are expected to be plain identifiers, as they are written to JSON unescaped.
+        uint32_t findStage(std::string_view stageName, Source source)
+        {
+            for (uint32_t i{0}; i < stages.size(); ++i)
+            {
+                if (stages[i].name == stageName && stages[i].source == source)
+                {
+                    return i;
+                }
+            }
+            stages.emplace_back(Stage{std::string{stageName}, source});
+            return static_cast<uint32_t>(stages.size() - 1);
+        }
+
+        void addSample(uint32_t stage, double seconds, uint64_t byteCount)
+        {
+            ++stages[stage].count;
+            stages[stage].seconds += seconds;
+            stages[stage].byteCount += byteCount;
+        }
+
+        void collect(uint32_t region, bool wait)
+        {
+            vk::QueryResultFlags flags{vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability};
+            if (wait)
+            {
+                flags |= vk::QueryResultFlagBits::eWait;
+            }
+            // Each timestamp is followed by its availability.
+            const auto [result, values]{
+                queryPool.getResults<uint64_t>(2 * region, 2, 4 * sizeof(uint64_t), 2 * sizeof(uint64_t), flags)};
+            if (result != vk::Result::eSuccess || !values[1] || !values[3])
+            {
+                return;
+            }
+            const uint64_t mask{timestampValidBits < 64 ? (uint64_t{1} << timestampValidBits) - 1 : ~uint64_t{0}};
+            const uint64_t ticks{(values[2] - values[0]) & mask};
+            addSample(gpuRegions[region].stage,
+                      static_cast<double>(ticks) * timestampPeriod * 1e-9,
+                      gpuRegions[region].byteCount);
+            gpuRegions[region].pending = false;
+            queryPool.reset(2 * region, 2);
+        }
+
+        float timestampPeriod{};
+        uint32_t timestampValidBits{};
+        std::vector<GpuRegion> gpuRegions{};
+        uint32_t nextGpuRegion{0};
+        vk::raii::QueryPool queryPool{VK_NULL_HANDLE};
+        std::vector<Stage> stages{};
+    };
+}
@@ -0,0 +1,269 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "include.hpp"
+
+#include "glslang_utils/GlslangContext.hpp"
+#include "vma_utils/BufferData.hpp"
+
+#include "utils.hpp"
+
+namespace intvlk
+{
+    enum class RadixSortPass : uint32_t
+    {
+        eHistogram,
+        eScan,
+        eScatter
+    };
+
+    class RadixSortPushConstants
+    {
+    public:
+        RadixSortPass pass;
+        uint32_t shift;
+        uint32_t keyCount;
+        uint32_t tilesPerGroup;
+        uint32_t groupCount;
+        vk::Bool32 hasPayloads;
+        vk::DeviceAddress keysIn;
+        vk::DeviceAddress keysOut;
+        vk::DeviceAddress payloadsIn;
+        vk::DeviceAddress payloadsOut;
+        vk::DeviceAddress histograms;
+    };
+
+    // Stable LSD radix sort of 32-bit keys, with optional 32-bit payloads, in four
+    // 8-bit passes. Each pass counts digits per workgroup, scans the counts in a
+    // single workgroup and scatters the keys, ranking equal digits within a
+    // subgroup with ballots. Devices without the needed subgroup operations can
+    // use sortOnCpu, which produces the same order.
+    class RadixSort
+    {
+    public:
+        static constexpr uint32_t tileSize{256};
+        static constexpr uint32_t maxGroupCount{1024};
+        static constexpr uint32_t passCount{4};
+
+        RadixSort(const vk::raii::PhysicalDevice &physicalDevice,
+                  const vk::raii::Device &device,
+                  const std::shared_ptr<VmaAllocator_T> &allocator,
+                  const glslang_utils::GlslangContext &glslContext,
+                  const vk::raii::PipelineCache &pipelineCache,
+                  uint32_t _maxKeyCount,
+                  bool withPayloads)
+            : maxKeyCount{_maxKeyCount},
+
+              tempKeyBufferData{makeStorageBuffer(device, allocator, static_cast<vk::DeviceSize>(maxKeyCount) * sizeof(uint32_t))},
+
+              tempPayloadBufferData{makeStorageBuffer(
+                  device,
+                  allocator,
+                  withPayloads ? static_cast<vk::DeviceSize>(maxKeyCount) * sizeof(uint32_t) : sizeof(uint32_t))},
+
+              histogramBufferData{makeStorageBuffer(
+                  device,
+                  allocator,
+                  static_cast<vk::DeviceSize>(tileSize) * maxGroupCount * sizeof(uint32_t))},
+
+              tempKeyBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{tempKeyBufferData.buffer})},
+
+              tempPayloadBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{tempPayloadBufferData.buffer})},
+
+              histogramBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{histogramBufferData.buffer})}
+        {
+            if (!isSupported(physicalDevice))
+            {
+                throw Error{"Radix sort is not supported by the device"};
+            }
+
+            vk::PushConstantRange pushConstantRange{vk::ShaderStageFlagBits::eCompute, 0, sizeof(RadixSortPushConstants)};
+
+            pipelineLayout = vk::raii::PipelineLayout{
+                device,
+                vk::PipelineLayoutCreateInfo{vk::PipelineLayoutCreateFlags{}, {}, pushConstantRange}};
+
+            const uint32_t maxSubgroupCount{getMaxSubgroupCount(physicalDevice)};
+            vk::SpecializationMapEntry specializationMapEntry{0, 0, sizeof(uint32_t)};
+            vk::SpecializationInfo specializationInfo{1, &specializationMapEntry, sizeof(uint32_t), &maxSubgroupCount};
+
+            vk::raii::ShaderModule computeShaderModule{glslContext.makeShaderModuleFromFile(
+                device,
+                vk::ShaderStageFlagBits::eCompute,
+                "src/shaders/radix_sort.comp")};
+
+            // Full subgroups keep gl_SubgroupID * gl_SubgroupSize + gl_SubgroupInvocationID a permutation of the tile.
+            vk::PipelineShaderStageCreateInfo pipelineShaderStageCreateInfo{
+                vk::PipelineShaderStageCreateFlagBits::eRequireFullSubgroups,
+                vk::ShaderStageFlagBits::eCompute,
+                computeShaderModule,
+                "main",
+                &specializationInfo};
+
+            vk::ComputePipelineCreateInfo computePipelineCreateInfo{vk::PipelineCreateFlags{},
+                                                                    pipelineShaderStageCreateInfo,
+                                                                    pipelineLayout};
+
+            pipeline = vk::raii::Pipeline{device, pipelineCache, computePipelineCreateInfo};
+        }
+
+        static uint32_t getMaxSubgroupCount(const vk::raii::PhysicalDevice &physicalDevice)
+        {
+            const auto properties{physicalDevice.getProperties2<vk::PhysicalDeviceProperties2,
+                                                                vk::PhysicalDeviceVulkan13Properties>()};
+            return tileSize / std::max(1U, properties.get<vk::PhysicalDeviceVulkan13Properties>().minSubgroupSize);
+        }
+
+        static bool isSupported(const vk::raii::PhysicalDevice &physicalDevice)
+        {
+            const auto properties{physicalDevice.getProperties2<vk::PhysicalDeviceProperties2,
+                                                                vk::PhysicalDeviceSubgroupProperties>()};
+            const auto &subgroupProperties{properties.get<vk::PhysicalDeviceSubgroupProperties>()};
+            const vk::SubgroupFeatureFlags requiredOperations{vk::SubgroupFeatureFlagBits::eBasic |
+                                                              vk::SubgroupFeatureFlagBits::eBallot |
+                                                              vk::SubgroupFeatureFlagBits::eArithmetic};
+            const size_t sharedMemorySize{(2 * tileSize + 1 + tileSize * getMaxSubgroupCount(physicalDevice)) *
+                                          sizeof(uint32_t)};
+            return (subgroupProperties.supportedStages & vk::ShaderStageFlagBits::eCompute) &&
+                   (subgroupProperties.supportedOperations & requiredOperations) == requiredOperations &&
+                   sharedMemorySize <= properties.get<vk::PhysicalDeviceProperties2>().properties.limits.maxComputeSharedMemorySize;
+        }
+
+        // Records the sort of keyCount keys in place. Payloads move with their keys
+        // unless payloads is zero. Both buffers need eShaderDeviceAddress usage, and
+        // their writes must be made visible to compute shaders before this.
+        void record(const vk::raii::CommandBuffer &commandBuffer,
+                    vk::DeviceAddress keys,
+                    vk::DeviceAddress payloads,
+                    uint32_t keyCount) const
+        {
+            assert(keyCount <= maxKeyCount);
+            if (keyCount == 0)
+            {
+                return;
+            }
+
+            const uint32_t tileCount{(keyCount + tileSize - 1) / tileSize};
+            const uint32_t tilesPerGroup{(tileCount + maxGroupCount - 1) / maxGroupCount};
+            const uint32_t groupCount{(tileCount + tilesPerGroup - 1) / tilesPerGroup};
+
+            RadixSortPushConstants pushConstants{RadixSortPass::eHistogram,
+                                                 0,
+                                                 keyCount,
+                                                 tilesPerGroup,
+                                                 groupCount,
+                                                 payloads != 0 ? vk::True : vk::False,
+                                                 keys,
+                                                 tempKeyBufferAddress,
+                                                 payloads,
+                                                 tempPayloadBufferAddress,
+                                                 histogramBufferAddress};
+
+            const vk::MemoryBarrier2 memoryBarrier{vk::PipelineStageFlagBits2::eComputeShader,
+                                                   vk::AccessFlagBits2::eShaderWrite,
+                                                   vk::PipelineStageFlagBits2::eComputeShader,
+                                                   vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite};
+            const auto dispatch{[&](RadixSortPass pass, uint32_t dispatchGroupCount)
+                                {
+                                    pushConstants.pass = pass;
+                                    commandBuffer.pushConstants<RadixSortPushConstants>(pipelineLayout,
+                                                                                        vk::ShaderStageFlagBits::eCompute,
+                                                                                        0,
+                                                                                        pushConstants);
+                                    commandBuffer.dispatch(dispatchGroupCount, 1, 1);
+                                    commandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, memoryBarrier});
+                                }};
+
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+            // An even number of passes leaves the result in the caller's buffers.
+            for (uint32_t pass{0}; pass < passCount; ++pass)
+            {
+                pushConstants.shift = 8 * pass;
+                dispatch(RadixSortPass::eHistogram, groupCount);
+                dispatch(RadixSortPass::eScan, 1);
+                dispatch(RadixSortPass::eScatter, groupCount);
+                std::swap(pushConstants.keysIn, pushConstants.keysOut);
+                std::swap(pushConstants.payloadsIn, pushConstants.payloadsOut);
+            }
+        }
+
+        // Same stable order as the GPU sort, for devices it does not support.
+        static void sortOnCpu(std::span<uint32_t> keys, std::span<uint32_t> payloads = {})
+        {
+            assert(payloads.empty() || payloads.size() == keys.size());
+            std::vector<uint32_t> tempKeys(keys.size());
+            std::vector<uint32_t> tempPayloads(payloads.size());
+            std::span<uint32_t> keysIn{keys};
+            std::span<uint32_t> keysOut{tempKeys};
+            std::span<uint32_t> payloadsIn{payloads};
+            std::span<uint32_t> payloadsOut{tempPayloads};
+            for (uint32_t pass{0}; pass < passCount; ++pass)
+            {
+                const uint32_t shift{8 * pass};
+                std::array<size_t, tileSize> offsets{};
+                for (const uint32_t key : keysIn)
+                {
+                    ++offsets[(key >> shift) & (tileSize - 1)];
+                }
+                size_t sum{0};
+                for (auto &offset : offsets)
+                {
+                    sum += std::exchange(offset, sum);
+                }
+                for (size_t i{0}; i < keysIn.size(); ++i)
+                {
+                    const size_t destination{offsets[(keysIn[i] >> shift) & (tileSize - 1)]++};
+                    keysOut[destination] = keysIn[i];
+                    if (!payloadsIn.empty())
+                    {
+                        payloadsOut[destination] = payloadsIn[i];
+                    }
+                }
+                std::swap(keysIn, keysOut);
+                std::swap(payloadsIn, payloadsOut);
+            }
+        }
+
+    private:
+        static vma_utils::BufferData makeStorageBuffer(const vk::raii::Device &device,
+                                                       const std::shared_ptr<VmaAllocator_T> &allocator,
+                                                       vk::DeviceSize size)
+        {
+            return vma_utils::BufferData{device,
+                                         allocator,
+                                         size,
+                                         vk::BufferUsageFlagBits::eStorageBuffer |
+                                             vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                                         VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                                         {},
+                                         VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                                             VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                                             VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT};
+        }
+
+        uint32_t maxKeyCount;
+        vma_utils::BufferData tempKeyBufferData;
+        vma_utils::BufferData tempPayloadBufferData;
+        vma_utils::BufferData histogramBufferData;
+        vk::DeviceAddress tempKeyBufferAddress;
+        vk::DeviceAddress tempPayloadBufferAddress;
+        vk::DeviceAddress histogramBufferAddress;
+        vk::raii::PipelineLayout pipelineLayout{VK_NULL_HANDLE};
+        vk::raii::Pipeline pipeline{VK_NULL_HANDLE};
+    };
+}
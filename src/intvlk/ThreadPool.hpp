@@ -0,0 +1,143 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace intvlk
+{
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(uint32_t threadCount = 0)
+        {
+            if (threadCount == 0)
+            {
+                threadCount = std::max(1U, std::thread::hardware_concurrency());
+            }
+            threads.reserve(threadCount);
+            for (uint32_t i{0}; i < threadCount; ++i)
+            {
+                threads.emplace_back([this]
+                                     { work(); });
+            }
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ThreadPool(ThreadPool &&) = delete;
+        ThreadPool &operator=(ThreadPool &&) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard lock{mutex};
+                stopping = true;
+            }
+            condition.notify_all();
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        template <typename Func>
+        std::future<std::invoke_result_t<Func>> submit(Func &&func)
+        {
+            auto task{std::make_shared<std::packaged_task<std::invoke_result_t<Func>()>>(std::forward<Func>(func))};
+            std::future<std::invoke_result_t<Func>> result{task->get_future()};
+            {
+                std::lock_guard lock{mutex};
+                tasks.emplace([task]
+                              { (*task)(); });
+            }
+            condition.notify_one();
+            return result;
+        }
+
+        // Waits for every future before getting any of them, so that no task outlives an
+        // error while it may still use the caller's state. Returns the results in order, or
+        // rethrows the error of the first future that failed.
+        template <typename Result>
+        static auto waitAll(std::vector<std::future<Result>> futures)
+        {
+            for (const auto &future : futures)
+            {
+                future.wait();
+            }
+
+            if constexpr (std::is_void_v<Result>)
+            {
+                for (auto &future : futures)
+                {
+                    future.get();
+                }
+            }
+            else
+            {
+                std::vector<Result> results{};
+                results.reserve(futures.size());
+                for (auto &future : futures)
+                {
+                    results.push_back(future.get());
+                }
+                return results;
+            }
+        }
+
+        uint32_t getThreadCount() const
+        {
+            return static_cast<uint32_t>(threads.size());
+        }
+
+    private:
+        void work()
+        {
+            while (true)
+            {
+                std::function<void()> task{};
+                {
+                    std::unique_lock lock{mutex};
+                    condition.wait(lock, [this]
+                                   { return stopping || !tasks.empty(); });
+                    if (tasks.empty())
+                    {
+                        return;
+                    }
+                    task = std::move(tasks.front());
+                    tasks.pop();
+                }
+                task();
+            }
+        }
+
+        std::mutex mutex{};
+        std::condition_variable condition{};
+        std::queue<std::function<void()>> tasks{};
+        bool stopping{false};
+        std::vector<std::thread> threads{};
+    };
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "include.hpp"
+
+#include "utils.hpp"
+
+namespace intvlk
+{
+    // A queue paired with a timeline semaphore. Every submit signals the next
+    // value of the timeline, so callers can poll or wait for one batch while
+    // later batches are still executing, instead of waiting for the whole queue.
+    // Submits must come from one thread at a time.
+    class TimelineQueue
+    {
+    public:
+        TimelineQueue(const vk::raii::Device &_device, uint32_t _queueFamilyIndex, uint32_t queueIndex = 0)
+            : device{_device},
+
+              queueFamilyIndex{_queueFamilyIndex},
+
+              queue{_device, _queueFamilyIndex, queueIndex},
+
+              semaphore{makeTimelineSemaphore(_device)}
+        {
+        }
+
+        static vk::raii::Semaphore makeTimelineSemaphore(const vk::raii::Device &device)
+        {
+            vk::StructureChain semaphoreCreateInfoChain{vk::SemaphoreCreateInfo{},
+                                                        vk::SemaphoreTypeCreateInfo{vk::SemaphoreType::eTimeline, 0}};
+            return vk::raii::Semaphore{device, semaphoreCreateInfoChain.get<vk::SemaphoreCreateInfo>()};
+        }
+
+        // Returns the timeline value that is reached once the command buffer has completed.
+        uint64_t submit(const vk::raii::CommandBuffer &commandBuffer,
+                        vk::ArrayProxy<const vk::SemaphoreSubmitInfo> waitSemaphoreSubmitInfos = {})
+        {
+            const uint64_t value{lastSubmittedValue + 1};
+            vk::CommandBufferSubmitInfo commandBufferSubmitInfo{commandBuffer};
+            vk::SemaphoreSubmitInfo signalSemaphoreSubmitInfo{semaphore, value, vk::PipelineStageFlagBits2::eAllCommands};
+            queue.submit2(vk::SubmitInfo2{vk::SubmitFlags{},
+                                          waitSemaphoreSubmitInfos,
+                                          commandBufferSubmitInfo,
+                                          signalSemaphoreSubmitInfo});
+            lastSubmittedValue = value;
+            return value;
+        }
+
+        // Lets a submit on another queue wait for value before stageMask.
+        vk::SemaphoreSubmitInfo makeWaitInfo(uint64_t value, vk::PipelineStageFlags2 stageMask) const
+        {
+            return vk::SemaphoreSubmitInfo{semaphore, value, stageMask};
+        }
+
+        bool isComplete(uint64_t value) const
+        {
+            return value <= semaphore.getCounterValue();
+        }
+
+        void wait(uint64_t value) const
+        {
+            vk::SemaphoreWaitInfo semaphoreWaitInfo{vk::SemaphoreWaitFlags{}, *semaphore, value};
+            while (vk::Result::eTimeout == device.waitSemaphores(semaphoreWaitInfo, std::numeric_limits<uint64_t>::max()))
+                ;
+        }
+
+        // Waits for everything submitted through this object, unlike vk::Queue::waitIdle.
+        void waitIdle() const
+        {
+            wait(lastSubmittedValue);
+        }
+
+        uint64_t getLastSubmittedValue() const
+        {
+            return lastSubmittedValue;
+        }
+
+        uint32_t getQueueFamilyIndex() const
+        {
+            return queueFamilyIndex;
+        }
+
+        const vk::raii::Queue &getQueue() const
+        {
+            return queue;
+        }
+
+    private:
+        const vk::raii::Device &device;
+        uint32_t queueFamilyIndex;
+        vk::raii::Queue queue;
+        vk::raii::Semaphore semaphore;
+        uint64_t lastSubmittedValue{0};
+    };
+
+    template <typename Func>
+    inline void oneTimeSubmit(const vk::raii::Device &device,
+                              const vk::raii::CommandPool &commandPool,
+                              TimelineQueue &queue,
+                              const Func &func)
+    {
+        vk::raii::CommandBuffer commandBuffer{
+            std::move(vk::raii::CommandBuffers{
+                device,
+                vk::CommandBufferAllocateInfo{commandPool, vk::CommandBufferLevel::ePrimary, 1}}[0])};
+        commandBuffer.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+        func(commandBuffer);
+        commandBuffer.end();
+        queue.wait(queue.submit(commandBuffer));
+    }
+}
@@ -24,5 +24,9 @@ namespace intvlk::glm_utils
     public:
         glm::mat4 renderMatrix{};
         vk::DeviceAddress vertexBufferAddress{};
+        // Model matrix of every instance, indexed by gl_InstanceIndex.
+        vk::DeviceAddress instanceBufferAddress{};
+        // QuantizedMesh::positionDecode of the mesh in the vertex buffer.
+        glm::vec4 positionDecode{};
     };
 }
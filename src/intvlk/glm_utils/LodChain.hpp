@@ -0,0 +1,472 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include "MeshAsset.hpp"
+#include "Meshlets.hpp"
+#include "QuantizedMesh.hpp"
+#include "Vertex.hpp"
+
+#include "../ThreadPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <future>
+#include <iterator>
+#include <queue>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace intvlk::glm_utils
+{
+    // Index buffers of a mesh from the full one down to ever coarser simplifications, one
+    // after another in indices, and the meshlets of every level. Every level draws the
+    // mesh's own vertices.
+    class LodChain
+    {
+    public:
+        static constexpr uint32_t maxLodCount{6};
+        // Each level aims at this fraction of the triangles of the one before.
+        static constexpr float reductionRatio{0.5f};
+        // Levels keeping more than this fraction are not worth their memory.
+        static constexpr float minReductionRatio{0.85f};
+        // Simplification stops short of moving the surface by this fraction of the mesh's size.
+        static constexpr float maxRelativeError{0.05f};
+
+        static LodChain make(std::span<const PackedVertex> vertices,
+                             std::span<const uint32_t> indices,
+                             const glm::vec4 &positionDecode)
+        {
+            LodChain chain{};
+            chain.indices.assign(indices.begin(), indices.end());
+            chain.lods.push_back(MeshLod{0, static_cast<uint32_t>(indices.size())});
+
+            Simplifier simplifier{vertices, indices, positionDecode};
+            const float maxError{maxRelativeError * positionDecode.w};
+            size_t triangleCount{indices.size() / 3};
+            while (chain.lods.size() < maxLodCount)
+            {
+                const float error{simplifier.simplify(static_cast<size_t>(reductionRatio * static_cast<float>(triangleCount)),
+                                                      maxError)};
+                const size_t simplifiedTriangleCount{simplifier.getTriangleCount()};
+                if (simplifiedTriangleCount == 0 ||
+                    minReductionRatio * static_cast<float>(triangleCount) < static_cast<float>(simplifiedTriangleCount))
+                {
+                    break;
+                }
+                const std::vector<uint32_t> lodIndices{simplifier.getIndices()};
+                chain.lods.push_back(MeshLod{static_cast<uint32_t>(chain.indices.size()),
+                                             static_cast<uint32_t>(lodIndices.size()),
+                                             0,
+                                             0,
+                                             error});
+                chain.indices.insert(chain.indices.end(), lodIndices.begin(), lodIndices.end());
+                triangleCount = simplifiedTriangleCount;
+            }
+
+            // Every level is split on its own, so its meshlets are a range of chain.meshlets.
+            for (auto &lod : chain.lods)
+            {
+                lod.meshletOffset = static_cast<uint32_t>(chain.meshlets.meshlets.size());
+                chain.meshlets.append(vertices, chain.indices, lod.firstIndex, lod.indexCount, positionDecode);
+                lod.meshletCount = static_cast<uint32_t>(chain.meshlets.meshlets.size()) - lod.meshletOffset;
+            }
+            return chain;
+        }
+
+        // Simplifies every mesh in a task of its own on threadPool and returns the chains in
+        // the order of meshes.
+        static std::vector<LodChain> makeInParallel(ThreadPool &threadPool, std::span<const MeshAsset> meshes)
+        {
+            std::vector<std::future<LodChain>> futureChains{};
+            futureChains.reserve(meshes.size());
+            for (const auto &mesh : meshes)
+            {
+                futureChains.push_back(threadPool.submit([&mesh]
+                                                         { return make(mesh.vertices, mesh.indices, mesh.positionDecode); }));
+            }
+            return ThreadPool::waitAll(std::move(futureChains));
+        }
+
+        std::vector<uint32_t> indices{};
+        std::vector<MeshLod> lods{};
+        Meshlets meshlets{};
+
+    private:
+        // Sum of the squared distances to the planes of triangles, weighted by their areas,
+        // as in Garland and Heckbert's quadric error metrics.
+        class Quadric
+        {
+        public:
+            static Quadric make(const glm::vec3 &normal, float distance, float weight)
+            {
+                const auto n{[&](int i)
+                             { return static_cast<double>(normal[i]); }};
+                const double d{distance};
+                const double w{weight};
+                return Quadric{{w * n(0) * n(0), w * n(0) * n(1), w * n(0) * n(2),
+                                w * n(1) * n(1), w * n(1) * n(2), w * n(2) * n(2),
+                                w * d * n(0), w * d * n(1), w * d * n(2), w * d * d},
+                               w};
+            }
+
+            Quadric &operator+=(const Quadric &other)
+            {
+                for (size_t i{0}; i < terms.size(); ++i)
+                {
+                    terms[i] += other.terms[i];
+                }
+                weight += other.weight;
+                return *this;
+            }
+
+            // Weighted mean squared distance of point to the planes.
+            double evaluate(const glm::vec3 &point) const
+            {
+                if (weight <= 0.0)
+                {
+                    return 0.0;
+                }
+                const double x{point.x};
+                const double y{point.y};
+                const double z{point.z};
+                const double error{terms[0] * x * x + 2.0 * terms[1] * x * y + 2.0 * terms[2] * x * z +
+                                   terms[3] * y * y + 2.0 * terms[4] * y * z + terms[5] * z * z +
+                                   2.0 * (terms[6] * x + terms[7] * y + terms[8] * z) + terms[9]};
+                return std::max(0.0, error / weight);
+            }
+
+            // The symmetric matrix of the plane normals, then the normals times the plane
+            // offsets, then the squared offsets.
+            std::array<double, 10> terms{};
+            double weight{};
+        };
+
+        // Collapses edges by moving one end onto the other, so the simplified triangles keep
+        // using the mesh's vertices. Vertices at the same position are collapsed together,
+        // which lets the surface simplify across color seams; open borders are kept.
+        class Simplifier
+        {
+        public:
+            Simplifier(std::span<const PackedVertex> _vertices,
+                       std::span<const uint32_t> indices,
+                       const glm::vec4 &positionDecode)
+                : vertices{_vertices}
+            {
+                std::unordered_map<uint64_t, uint32_t> pointOfPosition{};
+                pointOfVertex.reserve(vertices.size());
+                for (uint32_t i{0}; i < vertices.size(); ++i)
+                {
+                    const PackedVertex &vertex{vertices[i]};
+                    const uint64_t key{static_cast<uint64_t>(static_cast<uint16_t>(vertex.position[0])) |
+                                       static_cast<uint64_t>(static_cast<uint16_t>(vertex.position[1])) << 16 |
+                                       static_cast<uint64_t>(static_cast<uint16_t>(vertex.position[2])) << 32};
+                    auto [it, isInserted]{pointOfPosition.try_emplace(key, static_cast<uint32_t>(points.size()))};
+                    if (isInserted)
+                    {
+                        points.push_back(QuantizedMesh::decodePosition(vertex, positionDecode));
+                        verticesOfPoint.emplace_back();
+                    }
+                    pointOfVertex.push_back(it->second);
+                    verticesOfPoint[it->second].push_back(i);
+                }
+
+                quadrics.resize(points.size());
+                trianglesOfPoint.resize(points.size());
+                isLocked.resize(points.size(), false);
+                isRemoved.resize(points.size(), false);
+                versions.resize(points.size(), 0);
+
+                // Triangles that are already degenerate have no surface to keep.
+                std::unordered_map<uint64_t, uint32_t> edgeUseCounts{};
+                for (size_t i{0}; i + 2 < indices.size(); i += 3)
+                {
+                    const std::array<uint32_t, 3> triangle{indices[i], indices[i + 1], indices[i + 2]};
+                    const std::array<uint32_t, 3> trianglePoints{pointOfVertex[triangle[0]],
+                                                                 pointOfVertex[triangle[1]],
+                                                                 pointOfVertex[triangle[2]]};
+                    if (trianglePoints[0] == trianglePoints[1] ||
+                        trianglePoints[1] == trianglePoints[2] ||
+                        trianglePoints[2] == trianglePoints[0])
+                    {
+                        continue;
+                    }
+                    const auto t{static_cast<uint32_t>(triangles.size())};
+                    triangles.push_back(triangle);
+                    isAlive.push_back(true);
+                    const glm::vec3 normal{getNormal(points[trianglePoints[0]],
+                                                     points[trianglePoints[1]],
+                                                     points[trianglePoints[2]])};
+                    const float doubleArea{glm::length(normal)};
+                    for (size_t k{0}; k < 3; ++k)
+                    {
+                        trianglesOfPoint[trianglePoints[k]].push_back(t);
+                        ++edgeUseCounts[getEdgeKey(trianglePoints[k], trianglePoints[(k + 1) % 3])];
+                        if (0.0f < doubleArea)
+                        {
+                            const glm::vec3 unitNormal{normal / doubleArea};
+                            quadrics[trianglePoints[k]] += Quadric::make(unitNormal,
+                                                                         -glm::dot(unitNormal, points[trianglePoints[k]]),
+                                                                         0.5f * doubleArea);
+                        }
+                    }
+                }
+                triangleCount = triangles.size();
+
+                // Edges of one triangle lie on a border and edges of more on a non-manifold
+                // junction; moving their ends would open or tear the surface.
+                for (const auto &[edgeKey, useCount] : edgeUseCounts)
+                {
+                    if (useCount != 2)
+                    {
+                        isLocked[static_cast<uint32_t>(edgeKey)] = true;
+                        isLocked[static_cast<uint32_t>(edgeKey >> 32)] = true;
+                    }
+                }
+
+                for (uint32_t p{0}; p < points.size(); ++p)
+                {
+                    pushCollapses(p);
+                }
+            }
+
+            // Collapses the cheapest edges until at most targetTriangleCount triangles remain or
+            // every remaining collapse would move the surface by more than maxError. Returns the
+            // largest error of all collapses so far.
+            float simplify(size_t targetTriangleCount, float maxError)
+            {
+                const double maxSquaredError{static_cast<double>(maxError) * maxError};
+                while (targetTriangleCount < triangleCount && !collapses.empty())
+                {
+                    const Collapse collapse{collapses.top()};
+                    if (maxSquaredError < collapse.squaredError)
+                    {
+                        break;
+                    }
+                    collapses.pop();
+                    if (isRemoved[collapse.from] || isRemoved[collapse.to] ||
+                        versions[collapse.from] != collapse.fromVersion || versions[collapse.to] != collapse.toVersion ||
+                        !canCollapse(collapse.from, collapse.to))
+                    {
+                        continue;
+                    }
+                    applyCollapse(collapse.from, collapse.to);
+                    squaredError = std::max(squaredError, collapse.squaredError);
+                }
+                return static_cast<float>(std::sqrt(squaredError));
+            }
+
+            size_t getTriangleCount() const
+            {
+                return triangleCount;
+            }
+
+            // Remaining triangles in the order of the mesh, which keeps neighbours close.
+            std::vector<uint32_t> getIndices() const
+            {
+                std::vector<uint32_t> indices{};
+                indices.reserve(3 * triangleCount);
+                for (size_t t{0}; t < triangles.size(); ++t)
+                {
+                    if (isAlive[t])
+                    {
+                        indices.insert(indices.end(), triangles[t].begin(), triangles[t].end());
+                    }
+                }
+                return indices;
+            }
+
+        private:
+            class Collapse
+            {
+            public:
+                double squaredError;
+                uint32_t from;
+                uint32_t to;
+                uint32_t fromVersion;
+                uint32_t toVersion;
+
+                // Makes std::priority_queue pop the cheapest collapse first.
+                bool operator<(const Collapse &other) const
+                {
+                    return other.squaredError < squaredError;
+                }
+            };
+
+            // Triangles are clockwise seen from outside, see the front face of the pipelines.
+            static glm::vec3 getNormal(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c)
+            {
+                return glm::cross(c - a, b - a);
+            }
+
+            static uint64_t getEdgeKey(uint32_t p, uint32_t q)
+            {
+                return static_cast<uint64_t>(std::min(p, q)) | static_cast<uint64_t>(std::max(p, q)) << 32;
+            }
+
+            std::vector<uint32_t> getNeighbours(uint32_t p) const
+            {
+                std::vector<uint32_t> neighbours{};
+                for (const uint32_t t : trianglesOfPoint[p])
+                {
+                    if (!isAlive[t])
+                    {
+                        continue;
+                    }
+                    for (const uint32_t vertex : triangles[t])
+                    {
+                        if (pointOfVertex[vertex] != p)
+                        {
+                            neighbours.push_back(pointOfVertex[vertex]);
+                        }
+                    }
+                }
+                std::ranges::sort(neighbours);
+                neighbours.erase(std::ranges::unique(neighbours).begin(), neighbours.end());
+                return neighbours;
+            }
+
+            void pushCollapses(uint32_t p)
+            {
+                for (const uint32_t q : getNeighbours(p))
+                {
+                    Quadric quadric{quadrics[p]};
+                    quadric += quadrics[q];
+                    if (!isLocked[p])
+                    {
+                        collapses.push(Collapse{quadric.evaluate(points[q]), p, q, versions[p], versions[q]});
+                    }
+                    if (!isLocked[q])
+                    {
+                        collapses.push(Collapse{quadric.evaluate(points[p]), q, p, versions[q], versions[p]});
+                    }
+                }
+            }
+
+            bool canCollapse(uint32_t from, uint32_t to) const
+            {
+                // Ends sharing more than the two neighbours across the edge would pinch the
+                // surface into a non-manifold edge.
+                const std::vector<uint32_t> fromNeighbours{getNeighbours(from)};
+                const std::vector<uint32_t> toNeighbours{getNeighbours(to)};
+                std::vector<uint32_t> sharedNeighbours{};
+                std::ranges::set_intersection(fromNeighbours, toNeighbours, std::back_inserter(sharedNeighbours));
+                if (sharedNeighbours.size() != 2)
+                {
+                    return false;
+                }
+
+                // Triangles that stay must not flip over or become degenerate.
+                for (const uint32_t t : trianglesOfPoint[from])
+                {
+                    if (!isAlive[t])
+                    {
+                        continue;
+                    }
+                    std::array<glm::vec3, 3> corners{};
+                    std::array<glm::vec3, 3> movedCorners{};
+                    bool hasEdge{false};
+                    for (size_t k{0}; k < 3; ++k)
+                    {
+                        const uint32_t p{pointOfVertex[triangles[t][k]]};
+                        hasEdge = hasEdge || p == to;
+                        corners[k] = points[p];
+                        movedCorners[k] = p == from ? points[to] : points[p];
+                    }
+                    if (hasEdge)
+                    {
+                        continue;
+                    }
+                    const glm::vec3 normal{getNormal(corners[0], corners[1], corners[2])};
+                    const glm::vec3 movedNormal{getNormal(movedCorners[0], movedCorners[1], movedCorners[2])};
+                    const float length{glm::length(normal)};
+                    const float movedLength{glm::length(movedNormal)};
+                    if (movedLength <= 1e-12f || glm::dot(normal, movedNormal) <= 0.25f * length * movedLength)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            void applyCollapse(uint32_t from, uint32_t to)
+            {
+                for (const uint32_t t : trianglesOfPoint[from])
+                {
+                    if (!isAlive[t])
+                    {
+                        continue;
+                    }
+                    auto &triangle{triangles[t]};
+                    if (std::ranges::any_of(triangle, [&](uint32_t vertex)
+                                            { return pointOfVertex[vertex] == to; }))
+                    {
+                        isAlive[t] = false;
+                        --triangleCount;
+                        continue;
+                    }
+                    for (auto &vertex : triangle)
+                    {
+                        if (pointOfVertex[vertex] == from)
+                        {
+                            vertex = getMovedVertex(vertex, to);
+                        }
+                    }
+                    trianglesOfPoint[to].push_back(t);
+                }
+                trianglesOfPoint[from].clear();
+                quadrics[to] += quadrics[from];
+                isRemoved[from] = true;
+                ++versions[to];
+                pushCollapses(to);
+            }
+
+            // The vertex at point to with the same color, so seams stay where they were.
+            uint32_t getMovedVertex(uint32_t vertex, uint32_t to) const
+            {
+                for (const uint32_t candidate : verticesOfPoint[to])
+                {
+                    if (vertices[candidate].color == vertices[vertex].color)
+                    {
+                        return candidate;
+                    }
+                }
+                return verticesOfPoint[to].front();
+            }
+
+            std::span<const PackedVertex> vertices;
+            // Vertices at the same position share a point.
+            std::vector<uint32_t> pointOfVertex{};
+            std::vector<std::vector<uint32_t>> verticesOfPoint{};
+            std::vector<glm::vec3> points{};
+            std::vector<Quadric> quadrics{};
+            std::vector<std::vector<uint32_t>> trianglesOfPoint{};
+            std::vector<bool> isLocked{};
+            std::vector<bool> isRemoved{};
+            // Bumped whenever the quadric of a point changes, which outdates its queued collapses.
+            std::vector<uint32_t> versions{};
+            std::vector<std::array<uint32_t, 3>> triangles{};
+            std::vector<bool> isAlive{};
+            size_t triangleCount{};
+            std::priority_queue<Collapse> collapses{};
+            double squaredError{};
+        };
+    };
+}
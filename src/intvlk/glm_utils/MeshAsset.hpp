@@ -0,0 +1,225 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include "MeshImport.hpp"
+#include "QuantizedMesh.hpp"
+
+#include "../MappedFile.hpp"
+#include "../utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <span>
+
+namespace intvlk::glm_utils
+{
+    // Start of a mesh cache file, followed by the vertices and then the indices, both
+    // exactly as they are uploaded. The cache is only meant for the machine that wrote it,
+    // so it is in native byte order.
+    class MeshCacheHeader
+    {
+    public:
+        uint32_t magic{};
+        uint32_t version{};
+        // Identify the source file the cache was made from.
+        uint64_t sourceSize{};
+        int64_t sourceWriteTime{};
+        uint32_t vertexCount{};
+        uint32_t indexCount{};
+        std::array<float, 4> positionDecode{};
+        float boundingRadius{};
+        uint32_t reserved{};
+    };
+
+    static_assert(sizeof(MeshCacheHeader) == 56 && sizeof(PackedVertex) == 12,
+                  "Changing the mesh cache layout needs a new MeshAsset::cacheFormatVersion");
+
+    // Vertices and indices of a QuantizedMesh, either owned or read in place from a
+    // memory-mapped cache file. Loading a mesh file converts it once into a cache file
+    // in cacheDirectory; later loads of the unchanged file map the cache and pass its
+    // streams straight to UploadContext, with no parsing or copying on the way.
+    class MeshAsset
+    {
+    public:
+        static constexpr uint32_t cacheMagic{0x4853454D};
+        // Bumped whenever the cache layout or the conversion changes.
+        static constexpr uint32_t cacheFormatVersion{1};
+
+        MeshAsset() = default;
+
+        explicit MeshAsset(QuantizedMesh mesh)
+            : ownedMesh{std::move(mesh)}
+        {
+            vertices = ownedMesh.vertices;
+            indices = ownedMesh.indices;
+            positionDecode = ownedMesh.positionDecode;
+            boundingRadius = ownedMesh.boundingRadius;
+        }
+
+        // The streams point into ownedMesh or cacheFile, which keep their storage when moved.
+        MeshAsset(const MeshAsset &) = delete;
+        MeshAsset &operator=(const MeshAsset &) = delete;
+
+        MeshAsset(MeshAsset &&) = default;
+        MeshAsset &operator=(MeshAsset &&) = default;
+
+        // An empty cacheDirectory converts the file on every load.
+        static MeshAsset load(const std::filesystem::path &filename,
+                              const std::filesystem::path &cacheDirectory = "mesh_cache")
+        {
+            if (cacheDirectory.empty())
+            {
+                return MeshAsset{QuantizedMesh::make(importMesh(filename))};
+            }
+
+            const uint64_t sourceSize{std::filesystem::file_size(filename)};
+            const int64_t sourceWriteTime{
+                static_cast<int64_t>(std::filesystem::last_write_time(filename).time_since_epoch().count())};
+            const std::filesystem::path cacheFilename{
+                cacheDirectory / std::format("{:016x}.mesh", makeCacheKey(filename))};
+
+            if (std::optional<MeshAsset> asset{readCacheFile(cacheFilename, sourceSize, sourceWriteTime)})
+            {
+                return std::move(*asset);
+            }
+
+            QuantizedMesh mesh{QuantizedMesh::make(importMesh(filename))};
+            if (writeCacheFile(cacheDirectory, cacheFilename, mesh, sourceSize, sourceWriteTime))
+            {
+                if (std::optional<MeshAsset> asset{readCacheFile(cacheFilename, sourceSize, sourceWriteTime)})
+                {
+                    return std::move(*asset);
+                }
+            }
+            return MeshAsset{std::move(mesh)};
+        }
+
+        // FNV-1a of the absolute path, so every source file has its own cache file.
+        static uint64_t makeCacheKey(const std::filesystem::path &filename)
+        {
+            return fnv1a(std::filesystem::absolute(filename).lexically_normal().string());
+        }
+
+        std::span<const PackedVertex> vertices{};
+        std::span<const uint32_t> indices{};
+        // Same as in QuantizedMesh.
+        glm::vec4 positionDecode{0.0f, 0.0f, 0.0f, 1.0f};
+        float boundingRadius{};
+
+    private:
+        static size_t getVertexOffset()
+        {
+            return sizeof(MeshCacheHeader);
+        }
+
+        static size_t getIndexOffset(uint32_t vertexCount)
+        {
+            return getVertexOffset() + static_cast<size_t>(vertexCount) * sizeof(PackedVertex);
+        }
+
+        // Returns nothing when the file is missing, stale, cannot be mapped or does not hold
+        // a valid mesh cache, since the cache is only an optimization.
+        static std::optional<MeshAsset> readCacheFile(const std::filesystem::path &cacheFilename,
+                                                      uint64_t sourceSize,
+                                                      int64_t sourceWriteTime)
+        {
+            std::error_code errorCode{};
+            if (!std::filesystem::is_regular_file(cacheFilename, errorCode))
+            {
+                return std::nullopt;
+            }
+            MappedFile file{};
+            try
+            {
+                file = MappedFile{cacheFilename};
+            }
+            catch (const Error &)
+            {
+                return std::nullopt;
+            }
+            const std::span<const std::byte> data{file.getData()};
+            MeshCacheHeader header{};
+            if (data.size() < sizeof(header))
+            {
+                return std::nullopt;
+            }
+            memcpy(&header, data.data(), sizeof(header));
+            if (header.magic != cacheMagic ||
+                header.version != cacheFormatVersion ||
+                header.sourceSize != sourceSize ||
+                header.sourceWriteTime != sourceWriteTime ||
+                data.size() != getIndexOffset(header.vertexCount) + static_cast<size_t>(header.indexCount) * sizeof(uint32_t))
+            {
+                return std::nullopt;
+            }
+
+            MeshAsset asset{};
+            asset.vertices = std::span<const PackedVertex>{
+                reinterpret_cast<const PackedVertex *>(data.data() + getVertexOffset()), header.vertexCount};
+            asset.indices = std::span<const uint32_t>{
+                reinterpret_cast<const uint32_t *>(data.data() + getIndexOffset(header.vertexCount)), header.indexCount};
+            asset.positionDecode = glm::vec4{header.positionDecode[0],
+                                             header.positionDecode[1],
+                                             header.positionDecode[2],
+                                             header.positionDecode[3]};
+            asset.boundingRadius = header.boundingRadius;
+            // Indices past the vertices would make the draws read out of bounds.
+            if (std::ranges::any_of(asset.indices, [&header](uint32_t index)
+                                    { return header.vertexCount <= index; }))
+            {
+                return std::nullopt;
+            }
+            asset.cacheFile = std::move(file);
+            return asset;
+        }
+
+        // Failing to write the cache is not an error, for the same reason as in readCacheFile.
+        static bool writeCacheFile(const std::filesystem::path &cacheDirectory,
+                                   const std::filesystem::path &cacheFilename,
+                                   const QuantizedMesh &mesh,
+                                   uint64_t sourceSize,
+                                   int64_t sourceWriteTime)
+        {
+            const MeshCacheHeader header{cacheMagic,
+                                         cacheFormatVersion,
+                                         sourceSize,
+                                         sourceWriteTime,
+                                         static_cast<uint32_t>(mesh.vertices.size()),
+                                         static_cast<uint32_t>(mesh.indices.size()),
+                                         {mesh.positionDecode.x,
+                                          mesh.positionDecode.y,
+                                          mesh.positionDecode.z,
+                                          mesh.positionDecode.w},
+                                         mesh.boundingRadius,
+                                         0};
+            std::error_code errorCode{};
+            std::filesystem::create_directories(cacheDirectory, errorCode);
+            return writeFile(cacheFilename,
+                             {std::as_bytes(std::span{&header, 1}),
+                              std::as_bytes(std::span{mesh.vertices}),
+                              std::as_bytes(std::span{mesh.indices})});
+        }
+
+        QuantizedMesh ownedMesh{};
+        MappedFile cacheFile{};
+    };
+}
@@ -0,0 +1,616 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include "Vertex.hpp"
+
+#include "../errors.hpp"
+#include "../Json.hpp"
+#include "../MappedFile.hpp"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+// Converts OBJ and glTF 2.0 files into the triangle lists QuantizedMesh::make takes.
+// Triangles are reversed from the counter-clockwise winding of both formats into the
+// clockwise one of coloredCubeData. Faces without vertex colours are coloured by their
+// normal, since the cube pipeline has no lighting that would show their shape.
+namespace intvlk::glm_utils
+{
+    inline glm::vec4 getNormalColor(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c)
+    {
+        const glm::vec3 normal{glm::cross(b - a, c - a)};
+        const float length{glm::length(normal)};
+        if (length <= 0.0f)
+        {
+            return glm::vec4{0.5f, 0.5f, 0.5f, 1.0f};
+        }
+        return glm::vec4{0.5f * normal / length + 0.5f, 1.0f};
+    }
+
+    // Appends the triangle (a, b, c) of a counter-clockwise mesh.
+    inline void appendTriangle(std::vector<Vertex> &vertices,
+                               const glm::vec3 &a,
+                               const glm::vec3 &b,
+                               const glm::vec3 &c,
+                               const glm::vec4 *colors)
+    {
+        const glm::vec4 normalColor{colors ? glm::vec4{} : getNormalColor(a, b, c)};
+        vertices.push_back(Vertex{glm::vec4{a, 1.0f}, colors ? colors[0] : normalColor});
+        vertices.push_back(Vertex{glm::vec4{c, 1.0f}, colors ? colors[2] : normalColor});
+        vertices.push_back(Vertex{glm::vec4{b, 1.0f}, colors ? colors[1] : normalColor});
+    }
+
+    // Reads v and f statements; texture coordinates, normals, groups and materials are
+    // ignored. Vertex colours follow the common "v x y z r g b" extension and are only
+    // used when every vertex has one.
+    inline std::vector<Vertex> importObj(const std::filesystem::path &filename)
+    {
+        const MappedFile file{filename};
+        const std::string_view text{reinterpret_cast<const char *>(file.getData().data()), file.getData().size()};
+
+        std::vector<glm::vec3> positions{};
+        std::vector<glm::vec4> colors{};
+        bool hasColors{true};
+        // Position indices of the triangles, in the winding of the file.
+        std::vector<uint32_t> triangles{};
+        std::vector<uint32_t> face{};
+
+        size_t lineNumber{0};
+        const auto fail{[&](std::string_view message)
+                        {
+                            throw Error{filename.string() + ':' + std::to_string(lineNumber) + ": " + std::string{message}};
+                        }};
+        const auto isSpace{[](char c)
+                           { return c == ' ' || c == '\t' || c == '\r'; }};
+
+        size_t lineStart{0};
+        while (lineStart < text.size())
+        {
+            size_t lineEnd{text.find('\n', lineStart)};
+            if (lineEnd == std::string_view::npos)
+            {
+                lineEnd = text.size();
+            }
+            std::string_view line{text.substr(lineStart, lineEnd - lineStart)};
+            lineStart = lineEnd + 1;
+            ++lineNumber;
+
+            std::vector<std::string_view> tokens{};
+            size_t position{0};
+            while (position < line.size() && line[position] != '#')
+            {
+                while (position < line.size() && isSpace(line[position]))
+                {
+                    ++position;
+                }
+                const size_t tokenStart{position};
+                while (position < line.size() && !isSpace(line[position]) && line[position] != '#')
+                {
+                    ++position;
+                }
+                if (tokenStart < position)
+                {
+                    tokens.push_back(line.substr(tokenStart, position - tokenStart));
+                }
+            }
+            if (tokens.empty())
+            {
+                continue;
+            }
+
+            if (tokens[0] == "v")
+            {
+                if (tokens.size() < 4)
+                {
+                    fail("a vertex needs three coordinates");
+                }
+                std::array<float, 6> values{0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+                const size_t valueCount{std::min(tokens.size() - 1, values.size())};
+                for (size_t i{0}; i < valueCount; ++i)
+                {
+                    const std::string_view token{tokens[i + 1]};
+                    const auto [last, errorCode]{std::from_chars(token.data(), token.data() + token.size(), values[i])};
+                    if (errorCode != std::errc{} || last != token.data() + token.size())
+                    {
+                        fail("invalid number");
+                    }
+                }
+                positions.emplace_back(values[0], values[1], values[2]);
+                // "v x y z w" has a weight rather than a colour.
+                hasColors = hasColors && 7 <= tokens.size();
+                colors.emplace_back(values[3], values[4], values[5], 1.0f);
+            }
+            else if (tokens[0] == "f")
+            {
+                if (tokens.size() < 4)
+                {
+                    fail("a face needs at least three vertices");
+                }
+                face.clear();
+                for (size_t i{1}; i < tokens.size(); ++i)
+                {
+                    const std::string_view token{tokens[i].substr(0, tokens[i].find('/'))};
+                    int64_t index{};
+                    const auto [last, errorCode]{std::from_chars(token.data(), token.data() + token.size(), index)};
+                    if (errorCode != std::errc{} || last != token.data() + token.size() || index == 0)
+                    {
+                        fail("invalid vertex index");
+                    }
+                    // Negative indices count back from the last vertex read so far.
+                    const int64_t resolved{index < 0 ? static_cast<int64_t>(positions.size()) + index : index - 1};
+                    if (resolved < 0 || static_cast<int64_t>(positions.size()) <= resolved)
+                    {
+                        fail("vertex index out of range");
+                    }
+                    face.push_back(static_cast<uint32_t>(resolved));
+                }
+                // Polygons are assumed convex and split into a fan.
+                for (size_t i{2}; i < face.size(); ++i)
+                {
+                    triangles.insert(triangles.end(), {face[0], face[i - 1], face[i]});
+                }
+            }
+        }
+
+        std::vector<Vertex> vertices{};
+        vertices.reserve(triangles.size());
+        for (size_t i{0}; i < triangles.size(); i += 3)
+        {
+            const std::array<glm::vec4, 3> triangleColors{colors[triangles[i]],
+                                                          colors[triangles[i + 1]],
+                                                          colors[triangles[i + 2]]};
+            appendTriangle(vertices,
+                           positions[triangles[i]],
+                           positions[triangles[i + 1]],
+                           positions[triangles[i + 2]],
+                           hasColors ? triangleColors.data() : nullptr);
+        }
+        return vertices;
+    }
+
+    // Reads the triangle primitives of every mesh in the default scene, with the node
+    // transforms applied. Only POSITION, COLOR_0 and indices are used. Buffers must be
+    // in the GLB binary chunk or in separate files; embedded base64 data and sparse
+    // accessors are rejected.
+    class GltfImporter
+    {
+    public:
+        static constexpr uint32_t glbMagic{0x46546C67};
+        static constexpr uint32_t glbJsonChunkType{0x4E4F534A};
+        static constexpr uint32_t glbBinaryChunkType{0x004E4942};
+        static constexpr uint32_t maxNodeDepth{64};
+
+        explicit GltfImporter(const std::filesystem::path &_filename)
+            : filename{_filename},
+
+              file{_filename}
+        {
+            const std::span<const std::byte> data{file.getData()};
+            std::string_view jsonText{reinterpret_cast<const char *>(data.data()), data.size()};
+            std::span<const std::byte> binaryChunk{};
+            if (sizeof(uint32_t) <= data.size() && readUint32(data, 0) == glbMagic)
+            {
+                // 12-byte header followed by the JSON chunk and an optional binary chunk.
+                if (data.size() < 20 || readUint32(data, 4) != 2)
+                {
+                    fail("unsupported GLB version");
+                }
+                size_t offset{12};
+                while (offset + 8 <= data.size())
+                {
+                    const uint32_t chunkLength{readUint32(data, offset)};
+                    const uint32_t chunkType{readUint32(data, offset + 4)};
+                    if (data.size() - offset - 8 < chunkLength)
+                    {
+                        fail("truncated GLB chunk");
+                    }
+                    const std::span<const std::byte> chunk{data.subspan(offset + 8, chunkLength)};
+                    if (chunkType == glbJsonChunkType)
+                    {
+                        jsonText = std::string_view{reinterpret_cast<const char *>(chunk.data()), chunk.size()};
+                    }
+                    else if (chunkType == glbBinaryChunkType && binaryChunk.empty())
+                    {
+                        binaryChunk = chunk;
+                    }
+                    offset += 8 + (chunkLength + 3) / 4 * 4;
+                }
+            }
+            document = JsonValue::parse(jsonText);
+
+            if (const JsonValue *buffers{document.find("buffers")})
+            {
+                for (size_t i{0}; i < buffers->size(); ++i)
+                {
+                    const JsonValue *uri{(*buffers)[i].find("uri")};
+                    if (uri == nullptr)
+                    {
+                        bufferData.push_back(binaryChunk);
+                        continue;
+                    }
+                    if (uri->getString().starts_with("data:"))
+                    {
+                        fail("embedded base64 buffers are not supported");
+                    }
+                    const std::string &path{uri->getString()};
+                    bufferFiles.emplace_back(filename.parent_path() / std::filesystem::path{std::u8string{path.begin(), path.end()}});
+                    bufferData.push_back(bufferFiles.back().getData());
+                }
+            }
+        }
+
+        std::vector<Vertex> import() const
+        {
+            std::vector<Vertex> vertices{};
+            const JsonValue *scenes{document.find("scenes")};
+            if (scenes != nullptr && 0 < scenes->size())
+            {
+                const JsonValue &scene{(*scenes)[document.getUint("scene", 0)]};
+                if (const JsonValue *nodes{scene.find("nodes")})
+                {
+                    for (const auto &node : nodes->elements)
+                    {
+                        importNode(node.getUint(), glm::mat4{1.0f}, 0, vertices);
+                    }
+                }
+            }
+            else if (const JsonValue *meshes{document.find("meshes")})
+            {
+                // Without a scene, every mesh is drawn untransformed.
+                for (size_t i{0}; i < meshes->size(); ++i)
+                {
+                    importMesh((*meshes)[i], glm::mat4{1.0f}, vertices);
+                }
+            }
+            return vertices;
+        }
+
+    private:
+        [[noreturn]] void fail(std::string_view message) const
+        {
+            throw Error{filename.string() + ": " + std::string{message}};
+        }
+
+        static uint32_t readUint32(std::span<const std::byte> data, size_t offset)
+        {
+            uint32_t value{};
+            memcpy(&value, data.data() + offset, sizeof(value));
+            return value;
+        }
+
+        static glm::mat4 getLocalTransform(const JsonValue &node)
+        {
+            if (const JsonValue *matrix{node.find("matrix")})
+            {
+                glm::mat4 transform{};
+                for (uint32_t i{0}; i < 16; ++i)
+                {
+                    transform[i / 4][i % 4] = static_cast<float>((*matrix)[i].getNumber());
+                }
+                return transform;
+            }
+            const auto getVector{[&node](std::string_view key, glm::vec4 defaultValue)
+                                 {
+                                     if (const JsonValue *value{node.find(key)})
+                                     {
+                                         for (uint32_t i{0}; i < value->size(); ++i)
+                                         {
+                                             defaultValue[i] = static_cast<float>((*value)[i].getNumber());
+                                         }
+                                     }
+                                     return defaultValue;
+                                 }};
+            const glm::vec4 translation{getVector("translation", glm::vec4{0.0f})};
+            const glm::vec4 rotation{getVector("rotation", glm::vec4{0.0f, 0.0f, 0.0f, 1.0f})};
+            const glm::vec4 scale{getVector("scale", glm::vec4{1.0f})};
+            return glm::translate(glm::mat4{1.0f}, glm::vec3{translation}) *
+                   glm::mat4_cast(glm::quat{rotation.w, rotation.x, rotation.y, rotation.z}) *
+                   glm::scale(glm::mat4{1.0f}, glm::vec3{scale});
+        }
+
+        void importNode(uint32_t nodeIndex, const glm::mat4 &parentTransform, uint32_t depth, std::vector<Vertex> &vertices) const
+        {
+            if (maxNodeDepth < depth)
+            {
+                fail("node hierarchy too deep");
+            }
+            const JsonValue &node{document["nodes"][nodeIndex]};
+            const glm::mat4 transform{parentTransform * getLocalTransform(node)};
+            if (const JsonValue *mesh{node.find("mesh")})
+            {
+                importMesh(document["meshes"][mesh->getUint()], transform, vertices);
+            }
+            if (const JsonValue *children{node.find("children")})
+            {
+                for (const auto &child : children->elements)
+                {
+                    importNode(child.getUint(), transform, depth + 1, vertices);
+                }
+            }
+        }
+
+        void importMesh(const JsonValue &mesh, const glm::mat4 &transform, std::vector<Vertex> &vertices) const
+        {
+            for (const auto &primitive : mesh["primitives"].elements)
+            {
+                // Points, lines and strips are skipped.
+                if (primitive.getUint("mode", 4) != 4)
+                {
+                    continue;
+                }
+                const JsonValue &attributes{primitive["attributes"]};
+                const std::vector<glm::vec4> positions{readAccessor(attributes["POSITION"].getUint())};
+                std::vector<glm::vec4> colors{};
+                if (const JsonValue *color{attributes.find("COLOR_0")})
+                {
+                    colors = readAccessor(color->getUint());
+                    if (colors.size() != positions.size())
+                    {
+                        fail("COLOR_0 and POSITION counts differ");
+                    }
+                }
+                std::vector<uint32_t> indices{};
+                if (const JsonValue *indicesAccessor{primitive.find("indices")})
+                {
+                    indices = readIndices(indicesAccessor->getUint());
+                }
+                else
+                {
+                    indices.resize(positions.size());
+                    for (uint32_t i{0}; i < indices.size(); ++i)
+                    {
+                        indices[i] = i;
+                    }
+                }
+
+                for (size_t i{0}; i + 2 < indices.size(); i += 3)
+                {
+                    std::array<glm::vec3, 3> trianglePositions{};
+                    std::array<glm::vec4, 3> triangleColors{};
+                    for (size_t j{0}; j < 3; ++j)
+                    {
+                        const uint32_t index{indices[i + j]};
+                        if (positions.size() <= index)
+                        {
+                            fail("vertex index out of range");
+                        }
+                        trianglePositions[j] = glm::vec3{transform * glm::vec4{glm::vec3{positions[index]}, 1.0f}};
+                        if (!colors.empty())
+                        {
+                            triangleColors[j] = colors[index];
+                        }
+                    }
+                    appendTriangle(vertices,
+                                   trianglePositions[0],
+                                   trianglePositions[1],
+                                   trianglePositions[2],
+                                   colors.empty() ? nullptr : triangleColors.data());
+                }
+            }
+        }
+
+        static uint32_t getComponentSize(uint32_t componentType)
+        {
+            switch (componentType)
+            {
+            case 5120:
+            case 5121:
+                return 1;
+            case 5122:
+            case 5123:
+                return 2;
+            case 5125:
+            case 5126:
+                return 4;
+            default:
+                return 0;
+            }
+        }
+
+        static float readComponent(const std::byte *data, uint32_t componentType, bool normalized)
+        {
+            switch (componentType)
+            {
+            case 5120:
+            {
+                int8_t value{};
+                memcpy(&value, data, sizeof(value));
+                return normalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+            case 5121:
+            {
+                uint8_t value{};
+                memcpy(&value, data, sizeof(value));
+                return normalized ? value / 255.0f : value;
+            }
+            case 5122:
+            {
+                int16_t value{};
+                memcpy(&value, data, sizeof(value));
+                return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+            }
+            case 5123:
+            {
+                uint16_t value{};
+                memcpy(&value, data, sizeof(value));
+                return normalized ? value / 65535.0f : value;
+            }
+            case 5125:
+            {
+                uint32_t value{};
+                memcpy(&value, data, sizeof(value));
+                return static_cast<float>(value);
+            }
+            default:
+            {
+                float value{};
+                memcpy(&value, data, sizeof(value));
+                return value;
+            }
+            }
+        }
+
+        class AccessorView
+        {
+        public:
+            const std::byte *data{nullptr};
+            size_t count{};
+            size_t stride{};
+            uint32_t componentType{};
+            uint32_t componentCount{};
+            bool normalized{};
+        };
+
+        // Elements of an accessor without a buffer view are all zero.
+        AccessorView getAccessorView(uint32_t accessorIndex) const
+        {
+            const JsonValue &accessor{document["accessors"][accessorIndex]};
+            if (accessor.find("sparse") != nullptr)
+            {
+                fail("sparse accessors are not supported");
+            }
+            AccessorView view{};
+            view.count = accessor["count"].getUint();
+            view.componentType = accessor["componentType"].getUint();
+            const JsonValue *normalized{accessor.find("normalized")};
+            view.normalized = normalized != nullptr && normalized->boolean;
+            const std::string &type{accessor["type"].getString()};
+            view.componentCount = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+            const uint32_t componentSize{getComponentSize(view.componentType)};
+            if (view.componentCount == 0 || componentSize == 0)
+            {
+                fail("unsupported accessor type");
+            }
+            const size_t elementSize{static_cast<size_t>(componentSize) * view.componentCount};
+            view.stride = elementSize;
+
+            const JsonValue *bufferViewIndex{accessor.find("bufferView")};
+            if (bufferViewIndex == nullptr)
+            {
+                return view;
+            }
+            const JsonValue &bufferView{document["bufferViews"][bufferViewIndex->getUint()]};
+            const uint32_t bufferIndex{bufferView["buffer"].getUint()};
+            if (bufferData.size() <= bufferIndex)
+            {
+                fail("buffer index out of range");
+            }
+            const std::span<const std::byte> buffer{bufferData[bufferIndex]};
+            view.stride = bufferView.getUint("byteStride", static_cast<uint32_t>(elementSize));
+            const size_t viewOffset{bufferView.getUint("byteOffset", 0)};
+            const size_t viewLength{bufferView["byteLength"].getUint()};
+            const size_t offset{accessor.getUint("byteOffset", 0)};
+            if (buffer.size() < viewOffset + viewLength ||
+                (0 < view.count && viewLength < offset + (view.count - 1) * view.stride + elementSize))
+            {
+                fail("accessor out of the bounds of its buffer");
+            }
+            view.data = buffer.data() + viewOffset + offset;
+            return view;
+        }
+
+        // Every element widened to a vec4 with missing components of (0, 0, 0, 1).
+        std::vector<glm::vec4> readAccessor(uint32_t accessorIndex) const
+        {
+            const AccessorView view{getAccessorView(accessorIndex)};
+            const uint32_t componentSize{getComponentSize(view.componentType)};
+            std::vector<glm::vec4> elements(view.count, glm::vec4{0.0f, 0.0f, 0.0f, 1.0f});
+            if (view.data == nullptr)
+            {
+                return elements;
+            }
+            for (size_t i{0}; i < view.count; ++i)
+            {
+                for (uint32_t j{0}; j < view.componentCount; ++j)
+                {
+                    elements[i][j] = readComponent(view.data + i * view.stride + j * componentSize,
+                                                   view.componentType,
+                                                   view.normalized);
+                }
+            }
+            return elements;
+        }
+
+        std::vector<uint32_t> readIndices(uint32_t accessorIndex) const
+        {
+            const AccessorView view{getAccessorView(accessorIndex)};
+            if (view.componentCount != 1 || (view.componentType != 5121 && view.componentType != 5123 && view.componentType != 5125))
+            {
+                fail("indices must be unsigned scalars");
+            }
+            std::vector<uint32_t> indices(view.count);
+            if (view.data == nullptr)
+            {
+                return indices;
+            }
+            for (size_t i{0}; i < view.count; ++i)
+            {
+                const std::byte *element{view.data + i * view.stride};
+                switch (view.componentType)
+                {
+                case 5121:
+                    indices[i] = static_cast<uint8_t>(element[0]);
+                    break;
+                case 5123:
+                {
+                    uint16_t value{};
+                    memcpy(&value, element, sizeof(value));
+                    indices[i] = value;
+                    break;
+                }
+                default:
+                    memcpy(&indices[i], element, sizeof(uint32_t));
+                    break;
+                }
+            }
+            return indices;
+        }
+
+        std::filesystem::path filename;
+        MappedFile file;
+        std::vector<MappedFile> bufferFiles{};
+        // Contents of every buffer, in the GLB binary chunk or in bufferFiles.
+        std::vector<std::span<const std::byte>> bufferData{};
+        JsonValue document{};
+    };
+
+    // Picks the importer from the file extension.
+    inline std::vector<Vertex> importMesh(const std::filesystem::path &filename)
+    {
+        std::string extension{filename.extension().string()};
+        std::ranges::transform(extension, extension.begin(), [](unsigned char c)
+                               { return static_cast<char>(std::tolower(c)); });
+        if (extension == ".obj")
+        {
+            return importObj(filename);
+        }
+        if (extension == ".gltf" || extension == ".glb")
+        {
+            return GltfImporter{filename}.import();
+        }
+        throw Error{"Unsupported mesh format: " + filename.string()};
+    }
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include "QuantizedMesh.hpp"
+#include "Vertex.hpp"
+
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace intvlk::glm_utils
+{
+    // Cluster of triangles culled and drawn as a unit, in the layout read by
+    // vulkan_cube_cull.comp, vulkan_cube.task and vulkan_cube.mesh.
+    class Meshlet
+    {
+    public:
+        // Center in xyz and radius in w, in model space.
+        glm::vec4 boundingSphere{};
+        // Average outward normal in xyz and, in w, the sine of the half-angle of the cone
+        // around it holding every triangle normal; 1 when the cluster faces too many ways
+        // to ever be culled as a whole.
+        glm::vec4 normalCone{0.0f, 0.0f, 0.0f, 1.0f};
+        // First element of the meshlet in Meshlets::vertexIndices.
+        uint32_t vertexOffset{};
+        // First element in Meshlets::triangles, which is also the first of the meshlet's
+        // triangles in the mesh's index buffer.
+        uint32_t triangleOffset{};
+        uint32_t vertexCount{};
+        uint32_t triangleCount{};
+    };
+
+    static_assert(sizeof(Meshlet) == 48, "Meshlet must match its std430 layout in the shaders");
+
+    // Level of detail of a mesh, in the layout read by the culling shaders: a range of the
+    // index buffer holding every level, and of the meshlets made from that range.
+    class MeshLod
+    {
+    public:
+        uint32_t firstIndex{};
+        uint32_t indexCount{};
+        uint32_t meshletOffset{};
+        uint32_t meshletCount{};
+        // Estimated distance in model space between this level's surface and the mesh's.
+        float error{};
+    };
+
+    static_assert(sizeof(MeshLod) == 20, "MeshLod must match its std430 layout in the shaders");
+
+    // Splits an indexed mesh into meshlets sized for one mesh shader workgroup each.
+    class Meshlets
+    {
+    public:
+        static constexpr uint32_t maxVertexCount{64};
+        static constexpr uint32_t maxTriangleCount{124};
+
+        // Takes the triangles in index buffer order, starting a new meshlet whenever the next
+        // triangle would exceed either limit. The order of the triangles is kept, so the
+        // classic vertex pipeline draws a meshlet straight from the mesh's index buffer.
+        static Meshlets make(std::span<const PackedVertex> vertices,
+                             std::span<const uint32_t> indices,
+                             const glm::vec4 &positionDecode)
+        {
+            Meshlets result{};
+            result.append(vertices, indices, 0, indices.size(), positionDecode);
+            return result;
+        }
+
+        // Adds the meshlets of indexCount indices from firstIndex, which must be a multiple of 3.
+        // Meshlets never span two calls, so each call's meshlets are a range of their own.
+        void append(std::span<const PackedVertex> vertices,
+                    std::span<const uint32_t> indices,
+                    size_t firstIndex,
+                    size_t indexCount,
+                    const glm::vec4 &positionDecode)
+        {
+            // Vertex of the current meshlet for every mesh vertex whose stamp is the meshlet's index.
+            std::vector<uint32_t> localIndices(vertices.size());
+            std::vector<uint32_t> stamps(vertices.size(), std::numeric_limits<uint32_t>::max());
+
+            Meshlet meshlet{};
+            meshlet.vertexOffset = static_cast<uint32_t>(vertexIndices.size());
+            meshlet.triangleOffset = static_cast<uint32_t>(triangles.size());
+            const auto finishMeshlet{[&]
+                                     {
+                                         setBounds(meshlet, *this, vertices, indices, positionDecode);
+                                         meshlets.push_back(meshlet);
+                                         meshlet = Meshlet{};
+                                         meshlet.vertexOffset = static_cast<uint32_t>(vertexIndices.size());
+                                         meshlet.triangleOffset = static_cast<uint32_t>(triangles.size());
+                                     }};
+
+            for (size_t i{firstIndex}; i + 2 < firstIndex + indexCount; i += 3)
+            {
+                uint32_t newVertexCount{};
+                for (size_t k{0}; k < 3; ++k)
+                {
+                    newVertexCount += stamps[indices[i + k]] != meshlets.size() ? 1 : 0;
+                }
+                if (maxVertexCount < meshlet.vertexCount + newVertexCount || meshlet.triangleCount == maxTriangleCount)
+                {
+                    finishMeshlet();
+                }
+
+                const auto stamp{static_cast<uint32_t>(meshlets.size())};
+                uint32_t triangle{};
+                for (size_t k{0}; k < 3; ++k)
+                {
+                    const uint32_t index{indices[i + k]};
+                    if (stamps[index] != stamp)
+                    {
+                        stamps[index] = stamp;
+                        localIndices[index] = meshlet.vertexCount++;
+                        vertexIndices.push_back(index);
+                    }
+                    triangle |= localIndices[index] << 8 * k;
+                }
+                triangles.push_back(triangle);
+                ++meshlet.triangleCount;
+            }
+            if (0 < meshlet.triangleCount)
+            {
+                finishMeshlet();
+            }
+        }
+
+        std::vector<Meshlet> meshlets{};
+        // Mesh vertex of every meshlet vertex.
+        std::vector<uint32_t> vertexIndices{};
+        // Meshlet vertices of a triangle in the low three bytes.
+        std::vector<uint32_t> triangles{};
+
+    private:
+        // Bounds are taken from the decoded positions, so they hold what the GPU draws.
+        static void setBounds(Meshlet &meshlet,
+                              const Meshlets &result,
+                              std::span<const PackedVertex> vertices,
+                              std::span<const uint32_t> indices,
+                              const glm::vec4 &positionDecode)
+        {
+            const auto getPosition{[&](uint32_t index)
+                                   { return QuantizedMesh::decodePosition(vertices[index], positionDecode); }};
+
+            glm::vec3 minPosition{getPosition(result.vertexIndices[meshlet.vertexOffset])};
+            glm::vec3 maxPosition{minPosition};
+            for (uint32_t i{1}; i < meshlet.vertexCount; ++i)
+            {
+                const glm::vec3 position{getPosition(result.vertexIndices[meshlet.vertexOffset + i])};
+                minPosition = glm::min(minPosition, position);
+                maxPosition = glm::max(maxPosition, position);
+            }
+            const glm::vec3 center{0.5f * (minPosition + maxPosition)};
+            float radius{};
+            for (uint32_t i{0}; i < meshlet.vertexCount; ++i)
+            {
+                radius = std::max(radius, glm::length(getPosition(result.vertexIndices[meshlet.vertexOffset + i]) - center));
+            }
+            meshlet.boundingSphere = glm::vec4{center, radius};
+
+            // Triangles are clockwise seen from outside, see the front face of the pipelines.
+            std::vector<glm::vec3> normals{};
+            normals.reserve(meshlet.triangleCount);
+            glm::vec3 normalSum{};
+            for (uint32_t i{0}; i < meshlet.triangleCount; ++i)
+            {
+                const size_t first{3 * static_cast<size_t>(meshlet.triangleOffset + i)};
+                const glm::vec3 a{getPosition(indices[first])};
+                const glm::vec3 b{getPosition(indices[first + 1])};
+                const glm::vec3 c{getPosition(indices[first + 2])};
+                const glm::vec3 normal{glm::cross(c - a, b - a)};
+                const float length{glm::length(normal)};
+                if (0.0f < length)
+                {
+                    normals.push_back(normal / length);
+                    normalSum += normal / length;
+                }
+            }
+            const float sumLength{glm::length(normalSum)};
+            if (sumLength <= 1e-6f)
+            {
+                return;
+            }
+            const glm::vec3 axis{normalSum / sumLength};
+            float minDot{1.0f};
+            for (const auto &normal : normals)
+            {
+                minDot = std::min(minDot, glm::dot(axis, normal));
+            }
+            // Cones of half a sphere or more never pass the backface test.
+            if (0.0f < minDot)
+            {
+                meshlet.normalCone = glm::vec4{axis, std::sqrt(1.0f - minDot * minDot)};
+            }
+        }
+    };
+}
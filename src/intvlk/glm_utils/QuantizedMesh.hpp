@@ -0,0 +1,113 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include "Vertex.hpp"
+
+#include <map>
+#include <vector>
+
+namespace intvlk::glm_utils
+{
+    // Indexed mesh of PackedVertex, in the layout uploaded to the GPU.
+    class QuantizedMesh
+    {
+    public:
+        // Quantizes every vertex and merges the ones that become identical, so a triangle
+        // list of vertices turns into shared vertices and indices.
+        static QuantizedMesh make(const std::vector<Vertex> &vertices)
+        {
+            QuantizedMesh mesh{};
+            if (vertices.empty())
+            {
+                return mesh;
+            }
+
+            glm::vec3 minPosition{vertices.front().position};
+            glm::vec3 maxPosition{vertices.front().position};
+            for (const auto &vertex : vertices)
+            {
+                minPosition = glm::min(minPosition, glm::vec3{vertex.position});
+                maxPosition = glm::max(maxPosition, glm::vec3{vertex.position});
+            }
+            const glm::vec3 center{0.5f * (minPosition + maxPosition)};
+            const glm::vec3 halfExtent{0.5f * (maxPosition - minPosition)};
+            // A single scale keeps the quantization error the same along every axis.
+            float scale{std::max(halfExtent.x, std::max(halfExtent.y, halfExtent.z))};
+            if (scale <= 0.0f)
+            {
+                scale = 1.0f;
+            }
+            mesh.positionDecode = glm::vec4{center, scale};
+
+            std::map<std::pair<uint64_t, uint32_t>, uint32_t> indexOfVertex{};
+            mesh.indices.reserve(vertices.size());
+            for (const auto &vertex : vertices)
+            {
+                const PackedVertex packedVertex{pack(vertex, center, scale)};
+                const std::pair<uint64_t, uint32_t> key{
+                    static_cast<uint64_t>(static_cast<uint16_t>(packedVertex.position[0])) |
+                        static_cast<uint64_t>(static_cast<uint16_t>(packedVertex.position[1])) << 16 |
+                        static_cast<uint64_t>(static_cast<uint16_t>(packedVertex.position[2])) << 32,
+                    packedVertex.color};
+                auto [it, isInserted]{indexOfVertex.try_emplace(key, static_cast<uint32_t>(mesh.vertices.size()))};
+                if (isInserted)
+                {
+                    mesh.vertices.push_back(packedVertex);
+                }
+                mesh.indices.push_back(it->second);
+            }
+
+            // Measured on the decoded positions, which the quantization may have moved outwards.
+            for (const auto &packedVertex : mesh.vertices)
+            {
+                mesh.boundingRadius = std::max(mesh.boundingRadius,
+                                               glm::length(decodePosition(packedVertex, mesh.positionDecode)));
+            }
+            return mesh;
+        }
+
+        static PackedVertex pack(const Vertex &vertex, const glm::vec3 &center, float scale)
+        {
+            const glm::vec3 position{glm::clamp((glm::vec3{vertex.position} - center) / scale, -1.0f, 1.0f)};
+            const glm::vec4 color{glm::clamp(vertex.color, 0.0f, 1.0f)};
+            const auto snorm16{[](float value)
+                               { return static_cast<int16_t>(std::lround(value * 32767.0f)); }};
+            const auto unorm8{[](float value)
+                              { return static_cast<uint32_t>(std::lround(value * 255.0f)); }};
+            return PackedVertex{{snorm16(position.x), snorm16(position.y), snorm16(position.z), 0},
+                                unorm8(color.r) | unorm8(color.g) << 8 | unorm8(color.b) << 16 | unorm8(color.a) << 24};
+        }
+
+        // Matches the decoding in vulkan_cube.vert.
+        static glm::vec3 decodePosition(const PackedVertex &vertex, const glm::vec4 &positionDecode)
+        {
+            const glm::vec3 position{static_cast<float>(vertex.position[0]),
+                                     static_cast<float>(vertex.position[1]),
+                                     static_cast<float>(vertex.position[2])};
+            return glm::vec3{positionDecode} + positionDecode.w * glm::max(position / 32767.0f, -1.0f);
+        }
+
+        std::vector<PackedVertex> vertices{};
+        std::vector<uint32_t> indices{};
+        // Center of the bounds in xyz and the scale in w; a position is center + scale * snorm16.
+        glm::vec4 positionDecode{0.0f, 0.0f, 0.0f, 1.0f};
+        // Radius of the bounding sphere around the model space origin.
+        float boundingRadius{};
+    };
+}
@@ -25,4 +25,13 @@ namespace intvlk::glm_utils
         glm::vec4 position{};
         glm::vec4 color{};
     };
+
+    // Vertex of a QuantizedMesh, 12 instead of 32 bytes. The position is snorm16 relative
+    // to the mesh's bounds and the colour is unorm8, both decoded in vulkan_cube.vert.
+    class PackedVertex
+    {
+    public:
+        std::array<int16_t, 4> position{};
+        uint32_t color{};
+    };
 }
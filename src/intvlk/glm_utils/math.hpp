@@ -24,23 +24,51 @@
 
 namespace intvlk::glm_utils
 {
-    inline glm::mat4x4 createModelViewProjectionClipMatrix(vk::Extent2D const &extent)
+    // Scenes of sceneRadius around the origin are framed from the same direction as the
+    // single cube, which has a radius of sqrt(3), by moving the camera back and scaling
+    // the depth range with it by this factor.
+    inline float getViewScale(float sceneRadius)
     {
-        float fov{glm::radians(45.0f)};
-        if (extent.width > extent.height)
+        return std::max(1.0f, sceneRadius / glm::sqrt(3.0f));
+    }
+
+    // Camera position in world space.
+    inline glm::vec3 getViewPosition(float sceneRadius)
+    {
+        return getViewScale(sceneRadius) * glm::vec3{-5.0f, 3.0f, -10.0f};
+    }
+
+    inline float getAspectRatio(vk::Extent2D const &extent)
+    {
+        return static_cast<float>(extent.width) / static_cast<float>(extent.height);
+    }
+
+    // Vertical field of view of 45 degrees, widened on extents taller than wide so that the
+    // horizontal one never drops below it and the scene stays framed.
+    inline float getFieldOfView(vk::Extent2D const &extent)
+    {
+        const float fov{glm::radians(45.0f)};
+        if (extent.width < extent.height)
         {
-            fov *= static_cast<float>(extent.height) / static_cast<float>(extent.width);
+            return 2.0f * glm::atan(glm::tan(0.5f * fov) / getAspectRatio(extent));
         }
+        return fov;
+    }
+
+    // Frames a scene of sceneRadius around the origin.
+    inline glm::mat4x4 createViewProjectionClipMatrix(vk::Extent2D const &extent, float sceneRadius)
+    {
+        const float scale{getViewScale(sceneRadius)};
+        const float fov{getFieldOfView(extent)};
 
-        glm::mat4x4 model{1.0f};
-        glm::mat4x4 view{glm::lookAt(glm::vec3{-5.0f, 3.0f, -10.0f},
+        glm::mat4x4 view{glm::lookAt(getViewPosition(sceneRadius),
                                      glm::vec3{0.0f, 0.0f, 0.0f},
                                      glm::vec3{0.0f, -1.0f, 0.0f})};
-        glm::mat4x4 projection{glm::perspective(fov, 1.0f, 0.1f, 100.0f)};
+        glm::mat4x4 projection{glm::perspective(fov, getAspectRatio(extent), scale * 0.1f, scale * 100.0f)};
         glm::mat4x4 clip{1.0f, 0.0f, 0.0f, 0.0f,
                          0.0f, -1.0f, 0.0f, 0.0f,
                          0.0f, 0.0f, 0.5f, 0.0f,
                          0.0f, 0.0f, 0.5f, 1.0f}; // Vulkan clip space has inverted y and half z!
-        return clip * projection * view * model;
+        return clip * projection * view;
     }
 }
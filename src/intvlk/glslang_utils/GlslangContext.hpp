@@ -22,19 +22,46 @@
 
 #include "include.hpp"
 
+#include "../EmbeddedShaders.hpp"
 #include "../errors.hpp"
+#include "../ThreadPool.hpp"
+#include "../utils.hpp"
 
+#include <filesystem>
+#include <format>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
 
 namespace intvlk::glslang_utils
 {
+    class ShaderFile
+    {
+    public:
+        vk::ShaderStageFlagBits stage;
+        std::string_view filename;
+    };
+
+    // Compiles GLSL to SPIR-V with glslang, from any number of threads at once. Results
+    // are cached in memory and, unless cacheDirectory is empty, in one file per shader
+    // named after the hash of everything that affects the output, so later launches with
+    // unchanged shaders skip glslang and never initialize it.
     class GlslangContext
     {
     public:
-        GlslangContext()
+        // Bumped whenever the compile options below change the generated SPIR-V.
+        static constexpr uint32_t cacheFormatVersion{1};
+        static constexpr glslang::EShTargetClientVersion clientVersion{glslang::EShTargetVulkan_1_3};
+        static constexpr glslang::EShTargetLanguageVersion targetVersion{glslang::EShTargetSpv_1_6};
+        static constexpr EShMessages messages{static_cast<EShMessages>(EShMsgSpvRules | EShMsgVulkanRules)};
+        static constexpr int defaultVersion{100};
+        static constexpr uint32_t spirvMagicNumber{0x07230203};
+
+        explicit GlslangContext(std::filesystem::path _cacheDirectory = "shader_cache")
+            : cacheDirectory{std::move(_cacheDirectory)}
         {
-            glslang::InitializeProcess();
-        };
+        }
 
         GlslangContext(const GlslangContext &) = delete;
         GlslangContext &operator=(const GlslangContext &) = delete;
@@ -42,9 +69,13 @@ namespace intvlk::glslang_utils
         GlslangContext(GlslangContext &&) = delete;
         GlslangContext &operator=(GlslangContext &&) = delete;
 
-        ~GlslangContext()
+        ~GlslangContext() = default;
+
+        // glslang keeps process-wide state, so it is initialized once, on the first
+        // compilation of any context, and finalized when the program exits.
+        static void initializeProcess()
         {
-            glslang::FinalizeProcess();
+            static const GlslangProcess process{};
         }
 
         EShLanguage translateShaderStage(vk::ShaderStageFlagBits stage) const
@@ -95,10 +126,11 @@ namespace intvlk::glslang_utils
 
             glslang::TShader shader{stage};
             shader.setStrings(shaderStrings.data(), static_cast<int>(shaderStrings.size()));
+            // Subgroup operations need SPIR-V 1.3 or later.
+            shader.setEnvClient(glslang::EShClientVulkan, clientVersion);
+            shader.setEnvTarget(glslang::EShTargetSpv, targetVersion);
 
-            EShMessages messages{static_cast<EShMessages>(EShMsgSpvRules | EShMsgVulkanRules)};
-
-            if (!shader.parse(GetDefaultResources(), 100, false, messages))
+            if (!shader.parse(GetDefaultResources(), defaultVersion, false, messages))
             {
                 std::cerr << shader.getInfoLog() << '\n'
                           << shader.getInfoDebugLog() << '\n';
@@ -123,14 +155,157 @@ namespace intvlk::glslang_utils
         vk::raii::ShaderModule makeShaderModule(const vk::raii::Device &device,
                                                 vk::ShaderStageFlagBits shaderStage,
                                                 const std::string &shaderText) const
+        {
+            const std::vector<uint32_t> shaderSPV{compile(shaderStage, shaderText)};
+            return vk::raii::ShaderModule{device, vk::ShaderModuleCreateInfo{vk::ShaderModuleCreateFlags{}, shaderSPV}};
+        }
+
+        // Prefers the SPIR-V embedded at build time, which needs neither glslang nor the
+        // shader sources next to the executable, and compiles the file otherwise.
+        vk::raii::ShaderModule makeShaderModuleFromFile(const vk::raii::Device &device,
+                                                        vk::ShaderStageFlagBits shaderStage,
+                                                        std::string_view filename) const
+        {
+            if (const std::span<const uint32_t> embeddedShader{findEmbeddedShader(filename)}; !embeddedShader.empty())
+            {
+                return vk::raii::ShaderModule{device,
+                                              vk::ShaderModuleCreateInfo{vk::ShaderModuleCreateFlags{}, embeddedShader}};
+            }
+            return makeShaderModule(device, shaderStage, readFile(filename));
+        }
+
+        // Loads the files concurrently on threadPool and returns the modules in the order of shaderFiles.
+        std::vector<vk::raii::ShaderModule> makeShaderModulesFromFiles(const vk::raii::Device &device,
+                                                                       ThreadPool &threadPool,
+                                                                       std::span<const ShaderFile> shaderFiles) const
+        {
+            std::vector<std::future<std::vector<uint32_t>>> shaderSPVs{};
+            shaderSPVs.reserve(shaderFiles.size());
+            for (const auto &shaderFile : shaderFiles)
+            {
+                shaderSPVs.push_back(threadPool.submit([this, shaderFile]
+                                                       { return compileFile(shaderFile.stage, shaderFile.filename); }));
+            }
+            std::vector<vk::raii::ShaderModule> shaderModules{};
+            shaderModules.reserve(shaderFiles.size());
+            for (const auto &code : ThreadPool::waitAll(std::move(shaderSPVs)))
+            {
+                shaderModules.emplace_back(device, vk::ShaderModuleCreateInfo{vk::ShaderModuleCreateFlags{}, code});
+            }
+            return shaderModules;
+        }
+
+        std::vector<uint32_t> compileFile(vk::ShaderStageFlagBits shaderStage, std::string_view filename) const
+        {
+            if (const std::span<const uint32_t> embeddedShader{findEmbeddedShader(filename)}; !embeddedShader.empty())
+            {
+                return std::vector<uint32_t>{embeddedShader.begin(), embeddedShader.end()};
+            }
+            return compile(shaderStage, readFile(filename));
+        }
+
+        std::vector<uint32_t> compile(vk::ShaderStageFlagBits shaderStage, const std::string &shaderText) const
+        {
+            const uint64_t key{makeCacheKey(shaderStage, shaderText)};
+            {
+                std::lock_guard lock{mutex};
+                if (auto it{spirvCache.find(key)}; it != spirvCache.end())
+                {
+                    return it->second;
+                }
+            }
+
+            std::vector<uint32_t> shaderSPV{readCacheFile(key)};
+            if (shaderSPV.empty())
+            {
+                initializeProcess();
+                if (!GLSLtoSPV(shaderStage, shaderText, shaderSPV))
+                {
+                    throw Error{"Failed to compile shader!"};
+                }
+                writeCacheFile(key, shaderSPV);
+            }
+
+            std::lock_guard lock{mutex};
+            return spirvCache.try_emplace(key, std::move(shaderSPV)).first->second;
+        }
+
+        // FNV-1a over the source, the stage, the glslang version and the compile options.
+        static uint64_t makeCacheKey(vk::ShaderStageFlagBits shaderStage, const std::string &shaderText)
+        {
+            const glslang::Version version{glslang::GetVersion()};
+            const std::string options{std::to_string(cacheFormatVersion) + ' ' +
+                                      std::to_string(version.major) + '.' +
+                                      std::to_string(version.minor) + '.' +
+                                      std::to_string(version.patch) + version.flavor + ' ' +
+                                      std::to_string(static_cast<uint32_t>(shaderStage)) + ' ' +
+                                      std::to_string(clientVersion) + ' ' +
+                                      std::to_string(targetVersion) + ' ' +
+                                      std::to_string(messages) + ' ' +
+                                      std::to_string(defaultVersion) + '\n'};
+            return fnv1a(shaderText, fnv1a(options));
+        }
+
+    private:
+        class GlslangProcess
+        {
+        public:
+            GlslangProcess()
+            {
+                glslang::InitializeProcess();
+            }
+
+            ~GlslangProcess()
+            {
+                glslang::FinalizeProcess();
+            }
+        };
+
+        std::filesystem::path getCacheFilename(uint64_t key) const
+        {
+            return cacheDirectory / std::format("{:016x}.spv", key);
+        }
+
+        // Returns nothing when the file is missing or does not hold SPIR-V.
+        std::vector<uint32_t> readCacheFile(uint64_t key) const
         {
             std::vector<uint32_t> shaderSPV{};
-            if (!GLSLtoSPV(shaderStage, shaderText, shaderSPV))
+            if (cacheDirectory.empty())
             {
-                throw Error{"Failed to compile shader!"};
+                return shaderSPV;
             }
+            if (std::ifstream file{getCacheFilename(key), std::ios::binary | std::ios::ate})
+            {
+                const auto fileSize{static_cast<size_t>(file.tellg())};
+                if (fileSize == 0 || fileSize % sizeof(uint32_t) != 0)
+                {
+                    return shaderSPV;
+                }
+                shaderSPV.resize(fileSize / sizeof(uint32_t));
+                file.seekg(0);
+                file.read(reinterpret_cast<char *>(shaderSPV.data()), static_cast<std::streamsize>(fileSize));
+                if (!file || shaderSPV[0] != spirvMagicNumber)
+                {
+                    shaderSPV.clear();
+                }
+            }
+            return shaderSPV;
+        }
 
-            return vk::raii::ShaderModule{device, vk::ShaderModuleCreateInfo{vk::ShaderModuleCreateFlags{}, shaderSPV}};
+        // Failing to write the cache is not an error, the shader is compiled again next time.
+        void writeCacheFile(uint64_t key, const std::vector<uint32_t> &shaderSPV) const
+        {
+            if (cacheDirectory.empty())
+            {
+                return;
+            }
+            std::error_code errorCode{};
+            std::filesystem::create_directories(cacheDirectory, errorCode);
+            writeFile(getCacheFilename(key), {std::as_bytes(std::span{shaderSPV})});
         }
+
+        std::filesystem::path cacheDirectory;
+        mutable std::mutex mutex{};
+        mutable std::unordered_map<uint64_t, std::vector<uint32_t>> spirvCache{};
     };
 }
@@ -24,8 +24,14 @@
 
 #include "errors.hpp"
 
+#include <filesystem>
 #include <fstream>
+#include <initializer_list>
+#include <map>
 #include <numeric>
+#include <optional>
+#include <span>
+#include <string_view>
 #include <unordered_set>
 
 namespace intvlk
@@ -91,24 +97,32 @@ namespace intvlk
         return vk::False;
     }
 
+    // Largest extent of sourceExtent's aspect ratio that fits into destinationExtent, which
+    // is all of it when the aspect ratios match.
+    inline vk::Extent2D getBlitExtent(const vk::Extent2D &sourceExtent, const vk::Extent2D &destinationExtent)
+    {
+        const uint64_t sourceWidthByDestinationHeight{static_cast<uint64_t>(sourceExtent.width) * destinationExtent.height};
+        const uint64_t destinationWidthBySourceHeight{static_cast<uint64_t>(destinationExtent.width) * sourceExtent.height};
+        if (sourceWidthByDestinationHeight > destinationWidthBySourceHeight)
+        {
+            return vk::Extent2D{destinationExtent.width,
+                                static_cast<uint32_t>(destinationWidthBySourceHeight / sourceExtent.width)};
+        }
+        return vk::Extent2D{static_cast<uint32_t>(sourceWidthByDestinationHeight / sourceExtent.height),
+                            destinationExtent.height};
+    }
+
+    // Scales the source image to fit into the middle of the destination image, keeping its
+    // aspect ratio; the rest of the destination image is left as it is.
     inline void blitImage(const vk::raii::CommandBuffer &commandBuffer,
                           const vk::Image &sourceImage,
                           const vk::Extent2D &sourceExtent,
                           const vk::Image &destinationImage,
                           const vk::Extent2D &destinationExtent)
     {
-        float sourceAspectRatio{static_cast<float>(sourceExtent.width) / static_cast<float>(sourceExtent.height)};
-        float destinationAspectRatio{static_cast<float>(destinationExtent.width) / static_cast<float>(destinationExtent.height)};
-        uint32_t destinationWidth{destinationExtent.width};
-        uint32_t destinationHeight{destinationExtent.height};
-        if (sourceAspectRatio > destinationAspectRatio)
-        {
-            destinationHeight = static_cast<uint32_t>(static_cast<float>(destinationWidth) / sourceAspectRatio);
-        }
-        else
-        {
-            destinationWidth = static_cast<uint32_t>(static_cast<float>(destinationHeight) * sourceAspectRatio);
-        }
+        const vk::Extent2D blitExtent{getBlitExtent(sourceExtent, destinationExtent)};
+        const uint32_t destinationWidth{blitExtent.width};
+        const uint32_t destinationHeight{blitExtent.height};
         vk::ImageBlit2 blitRegion{
             vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eColor, 0, 0, 1},
             std::array<vk::Offset3D, 2>{vk::Offset3D{0, 0, 0},
@@ -143,6 +157,43 @@ namespace intvlk
         return static_cast<uint32_t>(std::distance(queueFamilyProperties.begin(), queueFamilyProperty));
     }
 
+    // Family that supports queueFlags but none of excludedQueueFlags, such as a
+    // transfer-only family backed by a DMA engine.
+    inline std::optional<uint32_t> findDedicatedQueueFamilyIndex(const vk::raii::PhysicalDevice &physicalDevice,
+                                                                 vk::QueueFlags queueFlags,
+                                                                 vk::QueueFlags excludedQueueFlags)
+    {
+        std::vector<vk::QueueFamilyProperties> queueFamilyProperties{physicalDevice.getQueueFamilyProperties()};
+        assert(queueFamilyProperties.size() < std::numeric_limits<uint32_t>::max());
+        auto queueFamilyProperty{
+            std::ranges::find_if(queueFamilyProperties, [queueFlags, excludedQueueFlags](const vk::QueueFamilyProperties &qfp)
+                                 { return (qfp.queueFlags & queueFlags) == queueFlags && !(qfp.queueFlags & excludedQueueFlags); })};
+        if (queueFamilyProperty == queueFamilyProperties.end())
+        {
+            return std::nullopt;
+        }
+        return static_cast<uint32_t>(std::distance(queueFamilyProperties.begin(), queueFamilyProperty));
+    }
+
+    // Compute family without graphics, which runs asynchronously to the graphics queue,
+    // or the first compute family.
+    inline uint32_t findComputeQueueFamilyIndex(const vk::raii::PhysicalDevice &physicalDevice)
+    {
+        return findDedicatedQueueFamilyIndex(physicalDevice, vk::QueueFlagBits::eCompute, vk::QueueFlagBits::eGraphics)
+            .value_or(findQueueFamilyIndex(physicalDevice, vk::QueueFlagBits::eCompute));
+    }
+
+    // Transfer family without graphics and compute, or fallbackQueueFamilyIndex. Graphics
+    // and compute families always support transfers, so any of them is a valid fallback.
+    inline uint32_t findTransferQueueFamilyIndex(const vk::raii::PhysicalDevice &physicalDevice,
+                                                 uint32_t fallbackQueueFamilyIndex)
+    {
+        return findDedicatedQueueFamilyIndex(physicalDevice,
+                                             vk::QueueFlagBits::eTransfer,
+                                             vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute)
+            .value_or(fallbackQueueFamilyIndex);
+    }
+
     inline std::pair<uint32_t, uint32_t> findGraphicsAndPresentQueueFamilyIndices(
         const vk::raii::PhysicalDevice &physicalDevice,
         const vk::raii::SurfaceKHR &surface)
@@ -311,6 +362,21 @@ namespace intvlk
         return {vk::KHRSwapchainExtensionName};
     }
 
+    // Task and mesh shaders of VK_EXT_mesh_shader, which makeDevice enables along with the extension.
+    inline bool isMeshShaderSupported(const vk::raii::PhysicalDevice &physicalDevice)
+    {
+        const std::vector<vk::ExtensionProperties> extensionProperties{physicalDevice.enumerateDeviceExtensionProperties()};
+        if (std::ranges::none_of(extensionProperties, [](const vk::ExtensionProperties &ep)
+                                 { return strcmp(vk::EXTMeshShaderExtensionName, ep.extensionName) == 0; }))
+        {
+            return false;
+        }
+        auto supportedFeatures{physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2,
+                                                           vk::PhysicalDeviceMeshShaderFeaturesEXT>()};
+        const auto &meshShaderFeatures{supportedFeatures.get<vk::PhysicalDeviceMeshShaderFeaturesEXT>()};
+        return meshShaderFeatures.taskShader && meshShaderFeatures.meshShader;
+    }
+
     inline std::vector<std::string> getInstanceExtensions()
     {
         std::vector<std::string> extensions{};
@@ -385,10 +451,60 @@ namespace intvlk
         return vk::raii::DescriptorSetLayout{device, descriptorSetLayoutCreateInfo};
     }
 
+    // A queue created together with the device.
+    class QueueRequest
+    {
+    public:
+        uint32_t queueFamilyIndex{};
+        // In [0, 1]; the implementation may give queues with a higher priority more device time.
+        float priority{0.0f};
+    };
+
+    // Index of the queue of each request within its family. Requests for the same family
+    // get distinct queues while the family has enough of them and share its last one after.
+    inline std::vector<uint32_t> getQueueIndices(const vk::raii::PhysicalDevice &physicalDevice,
+                                                 const std::vector<QueueRequest> &queueRequests)
+    {
+        std::vector<vk::QueueFamilyProperties> queueFamilyProperties{physicalDevice.getQueueFamilyProperties()};
+        std::vector<uint32_t> requestCounts(queueFamilyProperties.size(), 0);
+        std::vector<uint32_t> queueIndices{};
+        queueIndices.reserve(queueRequests.size());
+        for (const auto &queueRequest : queueRequests)
+        {
+            assert(queueRequest.queueFamilyIndex < queueFamilyProperties.size());
+            const uint32_t queueCount{queueFamilyProperties[queueRequest.queueFamilyIndex].queueCount};
+            queueIndices.push_back(std::min(requestCounts[queueRequest.queueFamilyIndex]++, queueCount - 1));
+        }
+        return queueIndices;
+    }
+
+    // Indirect draws with a draw count, several draws per call and a first instance are
+    // only enabled on request, so that the compute-only apps also run on devices without them.
     inline vk::raii::Device makeDevice(const vk::raii::PhysicalDevice &physicalDevice,
                                        const std::vector<std::string> &extensions,
-                                       uint32_t queueFamilyIndex)
+                                       const std::vector<QueueRequest> &queueRequests,
+                                       bool indirectDraws = false)
     {
+        // A shared queue gets the highest priority of the requests sharing it.
+        const std::vector<uint32_t> queueIndices{getQueueIndices(physicalDevice, queueRequests)};
+        std::map<uint32_t, std::vector<float>> queuePriorities{};
+        for (size_t i{0}; i < queueRequests.size(); ++i)
+        {
+            auto &familyQueuePriorities{queuePriorities[queueRequests[i].queueFamilyIndex]};
+            if (familyQueuePriorities.size() <= queueIndices[i])
+            {
+                familyQueuePriorities.resize(queueIndices[i] + 1, 0.0f);
+            }
+            familyQueuePriorities[queueIndices[i]] = std::max(familyQueuePriorities[queueIndices[i]],
+                                                              queueRequests[i].priority);
+        }
+        std::vector<vk::DeviceQueueCreateInfo> deviceQueueCreateInfos{};
+        deviceQueueCreateInfos.reserve(queuePriorities.size());
+        for (const auto &[queueFamilyIndex, familyQueuePriorities] : queuePriorities)
+        {
+            deviceQueueCreateInfos.emplace_back(vk::DeviceQueueCreateFlags{}, queueFamilyIndex, familyQueuePriorities);
+        }
+
         std::vector<const char *> enabledExtensions{};
         enabledExtensions.reserve(extensions.size());
         for (const auto &ext : extensions)
@@ -396,77 +512,70 @@ namespace intvlk
             enabledExtensions.emplace_back(ext.c_str());
         }
 
-        float queuePriority{0.0f};
-        vk::DeviceQueueCreateInfo deviceQueueCreateInfo{vk::DeviceQueueCreateFlags{},
-                                                        queueFamilyIndex,
-                                                        1,
-                                                        &queuePriority};
         vk::DeviceCreateInfo deviceCreateInfo{vk::DeviceCreateFlags{},
-                                              deviceQueueCreateInfo,
+                                              deviceQueueCreateInfos,
                                               {},
                                               enabledExtensions};
         vk::StructureChain deviceCreateInfoChain{deviceCreateInfo,
+                                                 vk::PhysicalDeviceFeatures2{}
+                                                     .setFeatures(vk::PhysicalDeviceFeatures{}
+                                                                      .setDrawIndirectFirstInstance(indirectDraws)
+                                                                      .setMultiDrawIndirect(indirectDraws)),
                                                  vk::PhysicalDeviceVulkan12Features{}
                                                      .setBufferDeviceAddress(vk::True)
-                                                     .setDescriptorIndexing(vk::True),
+                                                     .setDescriptorIndexing(vk::True)
+                                                     .setDrawIndirectCount(indirectDraws)
+                                                     .setHostQueryReset(vk::True)
+                                                     .setTimelineSemaphore(vk::True),
                                                  vk::PhysicalDeviceVulkan13Features{}
+                                                     .setComputeFullSubgroups(vk::True)
                                                      .setDynamicRendering(vk::True)
-                                                     .setSynchronization2(vk::True)};
+                                                     .setSynchronization2(vk::True),
+                                                 vk::PhysicalDeviceMeshShaderFeaturesEXT{}
+                                                     .setTaskShader(vk::True)
+                                                     .setMeshShader(vk::True)};
+        // Mesh shaders are optional, see isMeshShaderSupported.
+        if (std::ranges::find(extensions, vk::EXTMeshShaderExtensionName) == extensions.end())
+        {
+            deviceCreateInfoChain.unlink<vk::PhysicalDeviceMeshShaderFeaturesEXT>();
+        }
         auto supportedFeatures{physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2,
                                                            vk::PhysicalDeviceVulkan12Features,
                                                            vk::PhysicalDeviceVulkan13Features>()};
+        const auto &features{supportedFeatures.get<vk::PhysicalDeviceFeatures2>().features};
         const auto &vulkan12Features{supportedFeatures.get<vk::PhysicalDeviceVulkan12Features>()};
         const auto &vulkan13Features{supportedFeatures.get<vk::PhysicalDeviceVulkan13Features>()};
+        if (indirectDraws && !(features.drawIndirectFirstInstance && vulkan12Features.drawIndirectCount))
+        {
+            throw Error{"Failed to create a device that supports indirect draws with a draw count!"};
+        }
         assert(vulkan12Features.bufferDeviceAddress && vulkan12Features.descriptorIndexing &&
-               vulkan13Features.dynamicRendering && vulkan13Features.synchronization2);
+               vulkan12Features.hostQueryReset && vulkan12Features.timelineSemaphore &&
+               vulkan13Features.computeFullSubgroups && vulkan13Features.dynamicRendering &&
+               vulkan13Features.synchronization2);
         return vk::raii::Device{physicalDevice, deviceCreateInfoChain.get<vk::DeviceCreateInfo>()};
     }
 
+    inline vk::raii::Device makeDevice(const vk::raii::PhysicalDevice &physicalDevice,
+                                       const std::vector<std::string> &extensions,
+                                       uint32_t queueFamilyIndex)
+    {
+        return makeDevice(physicalDevice, extensions, std::vector<QueueRequest>{{queueFamilyIndex}});
+    }
+
+    // State shared by every graphics pipeline of the apps. Without a vertex input state the
+    // pipeline has no input assembly either, as with mesh shaders.
     inline vk::raii::Pipeline makeGraphicsPipeline(
         const vk::raii::Device &device,
         const vk::raii::PipelineCache &pipelineCache,
-        const vk::raii::ShaderModule &vertexShaderModule,
-        const vk::SpecializationInfo *vertexShaderSpecializationInfo,
-        const vk::raii::ShaderModule &fragmentShaderModule,
-        const vk::SpecializationInfo *fragmentShaderSpecializationInfo,
-        uint32_t vertexStride,
-        const std::vector<std::pair<vk::Format, uint32_t>> &vertexInputAttributeFormatOffset,
+        std::span<const vk::PipelineShaderStageCreateInfo> pipelineShaderStageCreateInfos,
+        const vk::PipelineVertexInputStateCreateInfo *pipelineVertexInputStateCreateInfo,
         vk::FrontFace frontFace,
         bool depthTested,
         const vk::raii::PipelineLayout &pipelineLayout,
         vk::Format colorFormat,
         vk::Format depthFormat)
     {
-        std::array<vk::PipelineShaderStageCreateInfo, 2> pipelineShaderStageCreateInfos{
-            vk::PipelineShaderStageCreateInfo{vk::PipelineShaderStageCreateFlags{},
-                                              vk::ShaderStageFlagBits::eVertex,
-                                              vertexShaderModule,
-                                              "main",
-                                              vertexShaderSpecializationInfo},
-            vk::PipelineShaderStageCreateInfo{vk::PipelineShaderStageCreateFlags{},
-                                              vk::ShaderStageFlagBits::eFragment,
-                                              fragmentShaderModule,
-                                              "main",
-                                              fragmentShaderSpecializationInfo}};
-
-        std::vector<vk::VertexInputAttributeDescription> vertexInputAttributeDescriptions{};
-        vk::PipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo{};
-        vk::VertexInputBindingDescription vertexInputBindingDescription{0, vertexStride};
-
-        if (0 < vertexStride)
-        {
-            vertexInputAttributeDescriptions.reserve(vertexInputAttributeFormatOffset.size());
-            for (uint32_t i{0}; i < vertexInputAttributeFormatOffset.size(); ++i)
-            {
-                vertexInputAttributeDescriptions.emplace_back(i,
-                                                              0,
-                                                              vertexInputAttributeFormatOffset[i].first,
-                                                              vertexInputAttributeFormatOffset[i].second);
-            }
-            pipelineVertexInputStateCreateInfo.setVertexBindingDescriptions(vertexInputBindingDescription);
-            pipelineVertexInputStateCreateInfo.setVertexAttributeDescriptions(vertexInputAttributeDescriptions);
-        }
-
         vk::PipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo{
             vk::PipelineInputAssemblyStateCreateFlags{},
             vk::PrimitiveTopology::eTriangleList};
@@ -534,8 +643,8 @@ namespace intvlk
         vk::StructureChain<vk::GraphicsPipelineCreateInfo, vk::PipelineRenderingCreateInfo>
             graphicsPipelineCreateInfoChain{{vk::PipelineCreateFlags{},
                                              pipelineShaderStageCreateInfos,
-                                             &pipelineVertexInputStateCreateInfo,
-                                             &pipelineInputAssemblyStateCreateInfo,
+                                             pipelineVertexInputStateCreateInfo,
+                                             pipelineVertexInputStateCreateInfo ? &pipelineInputAssemblyStateCreateInfo : nullptr,
                                              nullptr,
                                              &pipelineViewportStateCreateInfo,
                                              &pipelineRasterizationStateCreateInfo,
@@ -551,6 +660,101 @@ namespace intvlk
                                   graphicsPipelineCreateInfoChain.get<vk::GraphicsPipelineCreateInfo>()};
     }
 
+    inline vk::raii::Pipeline makeGraphicsPipeline(
+        const vk::raii::Device &device,
+        const vk::raii::PipelineCache &pipelineCache,
+        const vk::raii::ShaderModule &vertexShaderModule,
+        const vk::SpecializationInfo *vertexShaderSpecializationInfo,
+        const vk::raii::ShaderModule &fragmentShaderModule,
+        const vk::SpecializationInfo *fragmentShaderSpecializationInfo,
+        uint32_t vertexStride,
+        const std::vector<std::pair<vk::Format, uint32_t>> &vertexInputAttributeFormatOffset,
+        vk::FrontFace frontFace,
+        bool depthTested,
+        const vk::raii::PipelineLayout &pipelineLayout,
+        vk::Format colorFormat,
+        vk::Format depthFormat)
+    {
+        std::array<vk::PipelineShaderStageCreateInfo, 2> pipelineShaderStageCreateInfos{
+            vk::PipelineShaderStageCreateInfo{vk::PipelineShaderStageCreateFlags{},
+                                              vk::ShaderStageFlagBits::eVertex,
+                                              vertexShaderModule,
+                                              "main",
+                                              vertexShaderSpecializationInfo},
+            vk::PipelineShaderStageCreateInfo{vk::PipelineShaderStageCreateFlags{},
+                                              vk::ShaderStageFlagBits::eFragment,
+                                              fragmentShaderModule,
+                                              "main",
+                                              fragmentShaderSpecializationInfo}};
+
+        std::vector<vk::VertexInputAttributeDescription> vertexInputAttributeDescriptions{};
+        vk::PipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo{};
+        vk::VertexInputBindingDescription vertexInputBindingDescription{0, vertexStride};
+
+        if (0 < vertexStride)
+        {
+            vertexInputAttributeDescriptions.reserve(vertexInputAttributeFormatOffset.size());
+            for (uint32_t i{0}; i < vertexInputAttributeFormatOffset.size(); ++i)
+            {
+                vertexInputAttributeDescriptions.emplace_back(i,
+                                                              0,
+                                                              vertexInputAttributeFormatOffset[i].first,
+                                                              vertexInputAttributeFormatOffset[i].second);
+            }
+            pipelineVertexInputStateCreateInfo.setVertexBindingDescriptions(vertexInputBindingDescription);
+            pipelineVertexInputStateCreateInfo.setVertexAttributeDescriptions(vertexInputAttributeDescriptions);
+        }
+
+        return makeGraphicsPipeline(device,
+                                    pipelineCache,
+                                    pipelineShaderStageCreateInfos,
+                                    &pipelineVertexInputStateCreateInfo,
+                                    frontFace,
+                                    depthTested,
+                                    pipelineLayout,
+                                    colorFormat,
+                                    depthFormat);
+    }
+
+    // Graphics pipeline whose geometry comes from a task and a mesh shader.
+    inline vk::raii::Pipeline makeMeshPipeline(const vk::raii::Device &device,
+                                               const vk::raii::PipelineCache &pipelineCache,
+                                               const vk::raii::ShaderModule &taskShaderModule,
+                                               const vk::SpecializationInfo *taskShaderSpecializationInfo,
+                                               const vk::raii::ShaderModule &meshShaderModule,
+                                               const vk::raii::ShaderModule &fragmentShaderModule,
+                                               vk::FrontFace frontFace,
+                                               bool depthTested,
+                                               const vk::raii::PipelineLayout &pipelineLayout,
+                                               vk::Format colorFormat,
+                                               vk::Format depthFormat)
+    {
+        std::array<vk::PipelineShaderStageCreateInfo, 3> pipelineShaderStageCreateInfos{
+            vk::PipelineShaderStageCreateInfo{vk::PipelineShaderStageCreateFlags{},
+                                              vk::ShaderStageFlagBits::eTaskEXT,
+                                              taskShaderModule,
+                                              "main",
+                                              taskShaderSpecializationInfo},
+            vk::PipelineShaderStageCreateInfo{vk::PipelineShaderStageCreateFlags{},
+                                              vk::ShaderStageFlagBits::eMeshEXT,
+                                              meshShaderModule,
+                                              "main"},
+            vk::PipelineShaderStageCreateInfo{vk::PipelineShaderStageCreateFlags{},
+                                              vk::ShaderStageFlagBits::eFragment,
+                                              fragmentShaderModule,
+                                              "main"}};
+
+        return makeGraphicsPipeline(device,
+                                    pipelineCache,
+                                    pipelineShaderStageCreateInfos,
+                                    nullptr,
+                                    frontFace,
+                                    depthTested,
+                                    pipelineLayout,
+                                    colorFormat,
+                                    depthFormat);
+    }
+
     inline
 #if defined(NDEBUG)
         vk::StructureChain<vk::InstanceCreateInfo>
@@ -742,6 +946,42 @@ namespace intvlk
         throw std::runtime_error("Failed to open file: " + std::string{filename});
     }
 
+    inline constexpr uint64_t fnv1aOffsetBasis{0xCBF29CE484222325};
+
+    // FNV-1a of text, continued from hash so that several texts can be hashed as one.
+    inline uint64_t fnv1a(std::string_view text, uint64_t hash = fnv1aOffsetBasis)
+    {
+        for (const char c : text)
+        {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3;
+        }
+        return hash;
+    }
+
+    // Writes the pieces one after another into a temporary file that is renamed to filename
+    // once complete, so readers never see a partial file. Returns whether it succeeded.
+    inline bool writeFile(const std::filesystem::path &filename, std::initializer_list<std::span<const std::byte>> pieces)
+    {
+        std::filesystem::path temporaryFilename{filename};
+        temporaryFilename += ".tmp";
+        std::error_code errorCode{};
+        {
+            std::ofstream file{temporaryFilename, std::ios::binary | std::ios::trunc};
+            for (const auto &piece : pieces)
+            {
+                file.write(reinterpret_cast<const char *>(piece.data()), static_cast<std::streamsize>(piece.size()));
+            }
+            if (!file.flush())
+            {
+                file.close();
+                std::filesystem::remove(temporaryFilename, errorCode);
+                return false;
+            }
+        }
+        std::filesystem::rename(temporaryFilename, filename, errorCode);
+        return !errorCode;
+    }
+
     inline void setImageLayout(const vk::raii::CommandBuffer &commandBuffer,
                                vk::Image image,
                                vk::Format format,
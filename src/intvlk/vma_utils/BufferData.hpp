@@ -97,49 +97,6 @@ namespace intvlk::vma_utils
             return {std::move(buffer), allocation};
         }
 
-        template <typename DataType>
-        void upload(const vk::raii::Device &device,
-                    const vk::raii::CommandPool &commandPool,
-                    const vk::raii::Queue queue,
-                    const std::vector<DataType> &data,
-                    size_t stride = 0) const
-        {
-            if (memoryProperties & vk::MemoryPropertyFlagBits::eHostVisible)
-            {
-                size_t elementSize{stride ? stride : sizeof(DataType)};
-                assert(sizeof(DataType) <= elementSize);
-
-                copyToDevice(allocator.get(), allocation.get(), std::span{data}, elementSize);
-            }
-            else
-            {
-                assert(bufferUsage & vk::BufferUsageFlagBits::eTransferDst);
-                assert(memoryProperties & vk::MemoryPropertyFlagBits::eDeviceLocal);
-
-                size_t elementSize{stride ? stride : sizeof(DataType)};
-                assert(sizeof(DataType) <= elementSize);
-
-                size_t dataSize{data.size() * elementSize};
-                assert(dataSize <= size);
-
-                BufferData stagingBuffer{device,
-                                         allocator,
-                                         dataSize,
-                                         vk::BufferUsageFlagBits::eTransferSrc,
-                                         VMA_MEMORY_USAGE_AUTO,
-                                         {},
-                                         VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT};
-                copyToDevice(allocator.get(), stagingBuffer.allocation.get(), std::span{data}, elementSize);
-                vmaFlushAllocation(allocator.get(), stagingBuffer.allocation.get(), 0, dataSize);
-
-                oneTimeSubmit(device,
-                              commandPool,
-                              queue,
-                              [this, &stagingBuffer, dataSize](const vk::raii::CommandBuffer &cb)
-                              { cb.copyBuffer(stagingBuffer.buffer, buffer, vk::BufferCopy{0, 0, dataSize}); });
-            }
-        }
-
         const std::shared_ptr<VmaAllocator_T> &allocator{nullptr};
         std::shared_ptr<VmaAllocation_T> allocation{nullptr};
         vk::raii::Buffer buffer{VK_NULL_HANDLE};
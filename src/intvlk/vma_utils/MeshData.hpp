@@ -29,7 +29,8 @@ namespace intvlk::vma_utils
         MeshData(const vk::raii::Device &device,
                  const std::shared_ptr<VmaAllocator_T> &allocator,
                  vk::DeviceSize indexBufferSize,
-                 vk::DeviceSize vertexBufferSize)
+                 vk::DeviceSize vertexBufferSize,
+                 vk::DeviceSize instanceBufferSize = 0)
             : indexBuffer{makeIndexBuffer(device, allocator, indexBufferSize)},
 
               vertexBuffer{device,
@@ -41,11 +42,19 @@ namespace intvlk::vma_utils
                            VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
                            {},
                            VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
-                               VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT}
+                               VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                               VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT},
+
+              instanceBuffer{makeInstanceBuffer(device, allocator, instanceBufferSize)}
         {
             vk::BufferDeviceAddressInfo bufferDeviceAddressInfo{};
             bufferDeviceAddressInfo.buffer = *vertexBuffer.buffer;
             vertexBufferAddress = device.getBufferAddress(bufferDeviceAddressInfo);
+            if (instanceBufferSize > 0)
+            {
+                bufferDeviceAddressInfo.buffer = *instanceBuffer.buffer;
+                instanceBufferAddress = device.getBufferAddress(bufferDeviceAddressInfo);
+            }
         }
 
         MeshData(const vk::raii::Device &device,
@@ -67,6 +76,28 @@ namespace intvlk::vma_utils
                                   VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
                                   {},
                                   VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                                      VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                                      VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT};
+            }
+            return BufferData{nullptr};
+        }
+
+        static BufferData makeInstanceBuffer(const vk::raii::Device &device,
+                                             const std::shared_ptr<VmaAllocator_T> &allocator,
+                                             vk::DeviceSize instanceBufferSize)
+        {
+            if (instanceBufferSize > 0)
+            {
+                return BufferData{device,
+                                  allocator,
+                                  instanceBufferSize,
+                                  vk::BufferUsageFlagBits::eStorageBuffer |
+                                      vk::BufferUsageFlagBits::eTransferDst |
+                                      vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                                  VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                                  {},
+                                  VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                                      VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
                                       VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT};
             }
             return BufferData{nullptr};
@@ -75,5 +106,8 @@ namespace intvlk::vma_utils
         BufferData indexBuffer{nullptr};
         BufferData vertexBuffer{nullptr};
         vk::DeviceAddress vertexBufferAddress{};
+        // Per-instance data read through its device address, empty for meshes drawn once.
+        BufferData instanceBuffer{nullptr};
+        vk::DeviceAddress instanceBufferAddress{};
     };
 }
@@ -0,0 +1,79 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "include.hpp"
+
+#include "BufferData.hpp"
+
+namespace intvlk::vma_utils
+{
+    // Storage buffers of glm_utils::Meshlets and the glm_utils::MeshLod they were made for,
+    // read through their device addresses.
+    class MeshletData
+    {
+    public:
+        MeshletData(const vk::raii::Device &device,
+                    const std::shared_ptr<VmaAllocator_T> &allocator,
+                    vk::DeviceSize meshletBufferSize,
+                    vk::DeviceSize vertexIndexBufferSize,
+                    vk::DeviceSize triangleBufferSize,
+                    vk::DeviceSize lodBufferSize)
+            : meshletBuffer{makeStorageBuffer(device, allocator, meshletBufferSize)},
+
+              meshletBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{meshletBuffer.buffer})},
+
+              vertexIndexBuffer{makeStorageBuffer(device, allocator, vertexIndexBufferSize)},
+
+              vertexIndexBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{vertexIndexBuffer.buffer})},
+
+              triangleBuffer{makeStorageBuffer(device, allocator, triangleBufferSize)},
+
+              triangleBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{triangleBuffer.buffer})},
+
+              lodBuffer{makeStorageBuffer(device, allocator, lodBufferSize)},
+
+              lodBufferAddress{device.getBufferAddress(vk::BufferDeviceAddressInfo{lodBuffer.buffer})}
+        {
+        }
+
+        static BufferData makeStorageBuffer(const vk::raii::Device &device,
+                                            const std::shared_ptr<VmaAllocator_T> &allocator,
+                                            vk::DeviceSize bufferSize)
+        {
+            return BufferData{device,
+                              allocator,
+                              bufferSize,
+                              vk::BufferUsageFlagBits::eStorageBuffer |
+                                  vk::BufferUsageFlagBits::eTransferDst |
+                                  vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                              VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                              {},
+                              VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                                  VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                                  VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT};
+        }
+
+        BufferData meshletBuffer;
+        vk::DeviceAddress meshletBufferAddress;
+        BufferData vertexIndexBuffer;
+        vk::DeviceAddress vertexIndexBufferAddress;
+        BufferData triangleBuffer;
+        vk::DeviceAddress triangleBufferAddress;
+        BufferData lodBuffer;
+        vk::DeviceAddress lodBufferAddress;
+    };
+}
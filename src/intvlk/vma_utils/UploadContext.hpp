@@ -0,0 +1,319 @@
+#pragma once
+
+// Copyright(c) 2025, Bohdan Soproniuk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "include.hpp"
+
+#include "BufferData.hpp"
+
+#include "../TimelineQueue.hpp"
+#include "../utils.hpp"
+
+#include <deque>
+#include <optional>
+
+namespace intvlk::vma_utils
+{
+    // Completion of a flushed batch, as a value on the timeline of the destination queue.
+    class UploadToken
+    {
+    public:
+        uint64_t value{};
+    };
+
+    // Batches buffer uploads through one persistent staging ring. Uploads are copied
+    // into the ring right away and recorded into a single command buffer on flush,
+    // which is submitted on the transfer queue without waiting for it to complete.
+    // When the transfer queue belongs to another family than the destination queue,
+    // the uploaded ranges are released to the destination family and acquired there.
+    // Uploads overwrite their ranges, so a range acquired by an earlier batch is written
+    // again without being released back to the transfer family first.
+    // The ring is only reused once the batches that read from it have completed. It is
+    // allocated on the first upload that needs staging, so contexts that only write
+    // host-visible buffers never pay for it.
+    class UploadContext
+    {
+    public:
+        UploadContext(const vk::raii::Device &_device,
+                      const std::shared_ptr<VmaAllocator_T> &_allocator,
+                      TimelineQueue &_transferQueue,
+                      TimelineQueue &_dstQueue,
+                      vk::DeviceSize _stagingSize = 64 << 20)
+            : device{_device},
+
+              transferQueue{_transferQueue},
+
+              dstQueue{_dstQueue},
+
+              allocator{_allocator},
+
+              stagingSize{_stagingSize},
+
+              transferCommandPool{_device,
+                                  vk::CommandPoolCreateInfo{vk::CommandPoolCreateFlagBits::eTransient,
+                                                            _transferQueue.getQueueFamilyIndex()}},
+
+              dstCommandPool{_device,
+                             vk::CommandPoolCreateInfo{vk::CommandPoolCreateFlagBits::eTransient,
+                                                       _dstQueue.getQueueFamilyIndex()}}
+        {
+        }
+
+        UploadContext(const UploadContext &) = delete;
+        UploadContext &operator=(const UploadContext &) = delete;
+
+        UploadContext(UploadContext &&) = delete;
+        UploadContext &operator=(UploadContext &&) = delete;
+
+        ~UploadContext()
+        {
+            flush();
+            while (!pendingBatches.empty())
+            {
+                dstQueue.wait(pendingBatches.front().value);
+                pendingBatches.pop_front();
+            }
+        }
+
+        // Host-visible destinations are written directly; the caller must make sure
+        // the device is not using the range at the same time. Destinations need
+        // VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT to be placed in
+        // device-local memory that is not host-visible, which goes through the ring.
+        template <typename DataType>
+        void upload(const BufferData &bufferData, std::span<const DataType> data, vk::DeviceSize dstOffset = 0)
+        {
+            upload(bufferData, data.data(), data.size_bytes(), dstOffset);
+        }
+
+        template <typename DataType>
+        void upload(const BufferData &bufferData, const std::vector<DataType> &data, vk::DeviceSize dstOffset = 0)
+        {
+            upload(bufferData, std::span{data}, dstOffset);
+        }
+
+        void upload(const BufferData &bufferData, const void *data, vk::DeviceSize size, vk::DeviceSize dstOffset = 0)
+        {
+            if (bufferData.memoryProperties & vk::MemoryPropertyFlagBits::eHostVisible)
+            {
+                assert(bufferData.allocationInfo.pMappedData);
+                memcpy(static_cast<std::byte *>(bufferData.allocationInfo.pMappedData) + dstOffset, data, size);
+                vmaFlushAllocation(bufferData.allocator.get(), bufferData.allocation.get(), dstOffset, size);
+                return;
+            }
+
+            if (!stagingBufferData)
+            {
+                stagingBufferData.emplace(device,
+                                          allocator,
+                                          stagingSize,
+                                          vk::BufferUsageFlagBits::eTransferSrc,
+                                          VMA_MEMORY_USAGE_AUTO,
+                                          vk::MemoryPropertyFlags{},
+                                          VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
+            }
+
+            // Uploads larger than the ring are split into pieces that each fit into it.
+            const auto *bytes{static_cast<const std::byte *>(data)};
+            while (0 < size)
+            {
+                const vk::DeviceSize pieceSize{std::min(size, stagingSize)};
+                const vk::DeviceSize stagingOffset{allocate(pieceSize)};
+                memcpy(static_cast<std::byte *>(stagingBufferData->allocationInfo.pMappedData) + stagingOffset,
+                       bytes,
+                       pieceSize);
+                vmaFlushAllocation(stagingBufferData->allocator.get(),
+                                   stagingBufferData->allocation.get(),
+                                   stagingOffset,
+                                   pieceSize);
+                copies.push_back(Copy{*bufferData.buffer, vk::BufferCopy{stagingOffset, dstOffset, pieceSize}});
+
+                bytes += pieceSize;
+                dstOffset += pieceSize;
+                size -= pieceSize;
+            }
+        }
+
+        // Submits the uploads recorded since the last flush. Commands submitted to the
+        // destination queue afterwards see the uploaded data without further barriers.
+        UploadToken flush()
+        {
+            if (copies.empty())
+            {
+                return lastToken;
+            }
+
+            const bool isSameQueue{&transferQueue == &dstQueue};
+            const bool isOwnershipTransfer{transferQueue.getQueueFamilyIndex() != dstQueue.getQueueFamilyIndex()};
+
+            vk::raii::CommandBuffer transferCommandBuffer{makeCommandBuffer(device, transferCommandPool)};
+            transferCommandBuffer.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+            std::vector<vk::BufferMemoryBarrier2> bufferMemoryBarriers{};
+            for (const auto &copy : copies)
+            {
+                transferCommandBuffer.copyBuffer(*stagingBufferData->buffer, copy.buffer, copy.region);
+                if (isOwnershipTransfer)
+                {
+                    bufferMemoryBarriers.emplace_back(vk::PipelineStageFlagBits2::eCopy,
+                                                      vk::AccessFlagBits2::eTransferWrite,
+                                                      vk::PipelineStageFlagBits2::eNone,
+                                                      vk::AccessFlagBits2::eNone,
+                                                      transferQueue.getQueueFamilyIndex(),
+                                                      dstQueue.getQueueFamilyIndex(),
+                                                      copy.buffer,
+                                                      copy.region.dstOffset,
+                                                      copy.region.size);
+                }
+            }
+            if (isOwnershipTransfer)
+            {
+                transferCommandBuffer.pipelineBarrier2(
+                    vk::DependencyInfo{vk::DependencyFlags{}, {}, bufferMemoryBarriers, {}});
+            }
+            else if (isSameQueue)
+            {
+                vk::MemoryBarrier2 memoryBarrier{vk::PipelineStageFlagBits2::eCopy,
+                                                 vk::AccessFlagBits2::eTransferWrite,
+                                                 vk::PipelineStageFlagBits2::eAllCommands,
+                                                 vk::AccessFlagBits2::eMemoryRead};
+                transferCommandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, memoryBarrier});
+            }
+            transferCommandBuffer.end();
+            uint64_t value{transferQueue.submit(transferCommandBuffer)};
+
+            vk::raii::CommandBuffer dstCommandBuffer{nullptr};
+            if (!isSameQueue)
+            {
+                dstCommandBuffer = makeCommandBuffer(device, dstCommandPool);
+                dstCommandBuffer.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+                if (isOwnershipTransfer)
+                {
+                    for (auto &bufferMemoryBarrier : bufferMemoryBarriers)
+                    {
+                        bufferMemoryBarrier.setSrcStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+                            .setSrcAccessMask(vk::AccessFlagBits2::eNone)
+                            .setDstStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+                            .setDstAccessMask(vk::AccessFlagBits2::eMemoryRead);
+                    }
+                    dstCommandBuffer.pipelineBarrier2(
+                        vk::DependencyInfo{vk::DependencyFlags{}, {}, bufferMemoryBarriers, {}});
+                }
+                else
+                {
+                    vk::MemoryBarrier2 memoryBarrier{vk::PipelineStageFlagBits2::eAllCommands,
+                                                     vk::AccessFlagBits2::eNone,
+                                                     vk::PipelineStageFlagBits2::eAllCommands,
+                                                     vk::AccessFlagBits2::eMemoryRead};
+                    dstCommandBuffer.pipelineBarrier2(vk::DependencyInfo{vk::DependencyFlags{}, memoryBarrier});
+                }
+                dstCommandBuffer.end();
+                value = dstQueue.submit(dstCommandBuffer,
+                                        transferQueue.makeWaitInfo(value, vk::PipelineStageFlagBits2::eAllCommands));
+            }
+
+            pendingBatches.push_back(Batch{batchBegin,
+                                           value,
+                                           std::move(transferCommandBuffer),
+                                           std::move(dstCommandBuffer)});
+            batchBegin = head;
+            copies.clear();
+            lastToken = UploadToken{value};
+            return lastToken;
+        }
+
+        bool isComplete(UploadToken token) const
+        {
+            return dstQueue.isComplete(token.value);
+        }
+
+        void wait(UploadToken token) const
+        {
+            dstQueue.wait(token.value);
+        }
+
+    private:
+        class Copy
+        {
+        public:
+            vk::Buffer buffer{};
+            vk::BufferCopy region{};
+        };
+
+        class Batch
+        {
+        public:
+            // Position in the ring of the first byte read by the batch.
+            uint64_t begin{};
+            uint64_t value{};
+            vk::raii::CommandBuffer transferCommandBuffer{nullptr};
+            vk::raii::CommandBuffer dstCommandBuffer{nullptr};
+        };
+
+        // Positions grow monotonically and wrap into the ring modulo its size, so the
+        // used part of the ring is the range between the oldest pending batch and head.
+        // Returns the offset in the staging buffer of size contiguous bytes.
+        vk::DeviceSize allocate(vk::DeviceSize size)
+        {
+            while (!pendingBatches.empty() && dstQueue.isComplete(pendingBatches.front().value))
+            {
+                pendingBatches.pop_front();
+            }
+
+            while (true)
+            {
+                const uint64_t offset{head % stagingSize};
+                // Allocations do not wrap, the end of the ring is skipped instead.
+                const uint64_t begin{stagingSize < offset + size ? head + (stagingSize - offset) : head};
+                const uint64_t tail{pendingBatches.empty() ? batchBegin : pendingBatches.front().begin};
+                if (begin + size - tail <= stagingSize)
+                {
+                    head = begin + size;
+                    return begin % stagingSize;
+                }
+
+                if (!pendingBatches.empty())
+                {
+                    dstQueue.wait(pendingBatches.front().value);
+                    pendingBatches.pop_front();
+                }
+                else if (!copies.empty())
+                {
+                    flush();
+                }
+                else
+                {
+                    // The ring is idle, so the next allocation starts at its beginning.
+                    head = (head + stagingSize - 1) / stagingSize * stagingSize;
+                    batchBegin = head;
+                }
+            }
+        }
+
+        const vk::raii::Device &device;
+        TimelineQueue &transferQueue;
+        TimelineQueue &dstQueue;
+        const std::shared_ptr<VmaAllocator_T> &allocator;
+        vk::DeviceSize stagingSize;
+        std::optional<BufferData> stagingBufferData{};
+        vk::raii::CommandPool transferCommandPool;
+        vk::raii::CommandPool dstCommandPool;
+        std::vector<Copy> copies{};
+        std::deque<Batch> pendingBatches{};
+        uint64_t head{0};
+        uint64_t batchBegin{0};
+        UploadToken lastToken{};
+    };
+}
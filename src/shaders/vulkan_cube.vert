@@ -17,29 +17,44 @@
 
 #extension GL_EXT_buffer_reference : require
 
-struct Vertex
+// glm_utils::PackedVertex: snorm16 xyz with an unused w, and unorm8 RGBA.
+struct PackedVertex
 {
-    vec4 position;
-    vec4 color;
+    uint positionXY;
+    uint positionZW;
+    uint color;
 };
 
 layout (buffer_reference, std430) readonly buffer VertexBuffer
 {
-    Vertex vertices[];
+    PackedVertex vertices[];
+};
+
+layout (buffer_reference, std430) readonly buffer InstanceBuffer
+{
+    mat4 modelMatrices[];
 };
 
 layout (push_constant) uniform PushConstants
 {
     mat4 renderMatrix;
     VertexBuffer vertexBuffer;
+    InstanceBuffer instanceBuffer;
+    // Center of the mesh's bounds in xyz and the quantization scale in w.
+    vec4 positionDecode;
 } pushConstants;
 
 layout (location = 0) out vec4 outColor;
 
 void main()
 {
-    Vertex vertex = pushConstants.vertexBuffer.vertices[gl_VertexIndex];
+    PackedVertex vertex = pushConstants.vertexBuffer.vertices[gl_VertexIndex];
+
+    vec3 position = vec3(unpackSnorm2x16(vertex.positionXY), unpackSnorm2x16(vertex.positionZW).x);
+    position = pushConstants.positionDecode.xyz + pushConstants.positionDecode.w * position;
+
+    mat4 modelMatrix = pushConstants.instanceBuffer.modelMatrices[gl_InstanceIndex];
 
-    outColor = vertex.color;
-    gl_Position = pushConstants.renderMatrix * vertex.position;
+    outColor = unpackUnorm4x8(vertex.color);
+    gl_Position = pushConstants.renderMatrix * modelMatrix * vec4(position, 1.0);
 }